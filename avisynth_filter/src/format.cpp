@@ -24,21 +24,75 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     // 4:2:2
     // YUY2 interleaves Y and UV planes together, thus twice as wide as unpacked formats per pixel
     { .name = L"YUY2",  .mediaSubtype = MEDIASUBTYPE_YUY2,  .frameServerFormatId = VideoInfo::CS_YUY2,      .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_YUY2 },
+    // UYVY has no counterpart in AviSynth+, so it is split into planar YV16
+    { .name = L"UYVY",  .mediaSubtype = MEDIASUBTYPE_UYVY,  .frameServerFormatId = VideoInfo::CS_YV16,      .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_UYVY },
     { .name = L"P210",  .mediaSubtype = MEDIASUBTYPE_P210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P210 },
     { .name = L"P216",  .mediaSubtype = MEDIASUBTYPE_P216,  .frameServerFormatId = VideoInfo::CS_YUV422P16, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P216 },
+    // Y210 and Y216 interleave all planes in the Y0 U0 Y1 V0 order. Like P210, Y210 has the samples aligned to the most significant bits
+    { .name = L"Y210",  .mediaSubtype = MEDIASUBTYPE_Y210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y210 },
+    { .name = L"Y216",  .mediaSubtype = MEDIASUBTYPE_Y216,  .frameServerFormatId = VideoInfo::CS_YUV422P16, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y216 },
+    // v210 packs 6 pixels in every 16 bytes. Its bitCount is nominal, the stride comes from GetV210Stride()
+    { .name = L"v210",  .mediaSubtype = MEDIASUBTYPE_V210,  .frameServerFormatId = VideoInfo::CS_YUV422P10, .bitCount = 20, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_BIT_PACKED,         .resourceId = IDC_INPUT_FORMAT_V210 },
 
     // 4:4:4
     { .name = L"YV24",  .mediaSubtype = MEDIASUBTYPE_YV24,  .frameServerFormatId = VideoInfo::CS_YV24,      .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_SEPARATE,           .resourceId = IDC_INPUT_FORMAT_YV24 },
-    // Y41x from DirectShow contains alpha plane, which is used during video playback, therefore we ignore it and feed frame server YUV444
+    // Y41x and AYUV from DirectShow contain alpha plane, which is used during video playback, therefore we ignore it and feed frame server YUV444
     { .name = L"Y410",  .mediaSubtype = MEDIASUBTYPE_Y410,  .frameServerFormatId = VideoInfo::CS_YUV444P10, .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y410 },
     { .name = L"Y416",  .mediaSubtype = MEDIASUBTYPE_Y416,  .frameServerFormatId = VideoInfo::CS_YUV444P16, .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y416 },
+    { .name = L"AYUV",  .mediaSubtype = MEDIASUBTYPE_AYUV,  .frameServerFormatId = VideoInfo::CS_YV24,      .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_AYUV },
+    // semi-planar 4:4:4 formats interleave U and V in a plane twice as wide as Y. Like P010, P410 has the samples aligned to the most significant bits
+    { .name = L"NV24",  .mediaSubtype = MEDIASUBTYPE_NV24,  .frameServerFormatId = VideoInfo::CS_YV24,      .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_NV24 },
+    { .name = L"P410",  .mediaSubtype = MEDIASUBTYPE_P410,  .frameServerFormatId = VideoInfo::CS_YUV444P10, .bitCount = 48, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P410 },
+    { .name = L"P416",  .mediaSubtype = MEDIASUBTYPE_P416,  .frameServerFormatId = VideoInfo::CS_YUV444P16, .bitCount = 48, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P416 },
 
     // RGB
     { .name = L"RGB24", .mediaSubtype = MEDIASUBTYPE_RGB24, .frameServerFormatId = VideoInfo::CS_BGR24,     .bitCount = 24, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB24 },
     { .name = L"RGB32", .mediaSubtype = MEDIASUBTYPE_RGB32, .frameServerFormatId = VideoInfo::CS_BGR32,     .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB32 },
-    // RGB48 from LAV Filters outputs R-G-B pixel order while AviSynth+ expects B-G-R
+    // RGB48 and RGB64 from DirectShow are in R-G-B pixel order while AviSynth+ expects B-G-R, therefore the components are swapped during the copy
+    { .name = L"RGB48", .mediaSubtype = MEDIASUBTYPE_RGB48, .frameServerFormatId = VideoInfo::CS_BGR48,     .bitCount = 48, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB48 },
+    { .name = L"RGB64", .mediaSubtype = MEDIASUBTYPE_RGB64, .frameServerFormatId = VideoInfo::CS_BGR64,     .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB64 },
 };
 
+auto Format::GetReducedFrameServerFormatId(int frameServerFormatId, int bitsPerComponent) -> std::optional<int> {
+    VideoInfo videoInfo {};
+    videoInfo.pixel_type = frameServerFormatId;
+
+    // only integer YUV of 16-bit containers are reduced
+    if (!videoInfo.IsPlanar() || !videoInfo.IsYUV() || videoInfo.ComponentSize() != 2 || videoInfo.BitsPerComponent() <= bitsPerComponent) {
+        return std::nullopt;
+    }
+
+    return (frameServerFormatId & ~VideoInfo::CS_Sample_Bits_Mask) | (bitsPerComponent == 8 ? VideoInfo::CS_Sample_Bits_8 : VideoInfo::CS_Sample_Bits_10);
+}
+
+auto Format::GetResampledFrameServerFormatId(int frameServerFormatId, int subsampleWidthRatio, int subsampleHeightRatio) -> std::optional<int> {
+    VideoInfo videoInfo {};
+    videoInfo.pixel_type = frameServerFormatId;
+
+    // only integer planar YUV with chroma subsampled by at most 2 in each direction
+    if (!videoInfo.IsPlanar() || !videoInfo.IsYUV() || videoInfo.IsY() || videoInfo.ComponentSize() > 2 ||
+        videoInfo.GetPlaneWidthSubsampling(PLANAR_U) > 1 || videoInfo.GetPlaneHeightSubsampling(PLANAR_U) > 1) {
+        return std::nullopt;
+    }
+
+    if (1 << videoInfo.GetPlaneWidthSubsampling(PLANAR_U) == subsampleWidthRatio && 1 << videoInfo.GetPlaneHeightSubsampling(PLANAR_U) == subsampleHeightRatio) {
+        return std::nullopt;
+    }
+
+    return (frameServerFormatId & ~(VideoInfo::CS_Sub_Width_Mask | VideoInfo::CS_Sub_Height_Mask)) |
+        (subsampleWidthRatio == 1 ? VideoInfo::CS_Sub_Width_1 : VideoInfo::CS_Sub_Width_2) |
+        (subsampleHeightRatio == 1 ? VideoInfo::CS_Sub_Height_1 : VideoInfo::CS_Sub_Height_2);
+}
+
+auto Format::IsConvertibleToRGB32(int frameServerFormatId) -> bool {
+    VideoInfo videoInfo {};
+    videoInfo.pixel_type = frameServerFormatId;
+
+    // 8-bit planar YUV with chroma subsampled by at most 2 in each direction
+    return videoInfo.IsPlanar() && videoInfo.IsYUV() && !videoInfo.IsY() && videoInfo.ComponentSize() == 1 &&
+        videoInfo.GetPlaneWidthSubsampling(PLANAR_U) <= 1 && videoInfo.GetPlaneHeightSubsampling(PLANAR_U) <= 1;
+}
+
 auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat {
     const VIDEOINFOHEADER *vih = reinterpret_cast<VIDEOINFOHEADER *>(mediaType.pbFormat);
     const REFERENCE_TIME frameDuration = vih->AvgTimePerFrame > 0 ? vih->AvgTimePerFrame : DEFAULT_AVG_TIME_PER_FRAME;
@@ -46,8 +100,6 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
     VideoFormat ret {
         .pixelFormat = LookupMediaSubtype(mediaType.subtype),
         .videoInfo = {
-            .width = vih->rcSource.right - vih->rcSource.left,
-            .height = vih->rcSource.bottom - vih->rcSource.top,
             .fps_numerator = UNITS,
             .fps_denominator = static_cast<unsigned int>(frameDuration),
             .num_frames = NUM_FRAMES_FOR_INFINITE_STREAM,
@@ -55,7 +107,17 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
         },
         .bmi = *GetBitmapInfo(mediaType),
         .outputBufferTemporalFlags = ret.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && ret.videoInfo.BitsPerComponent() == 10,
+        .kernels = &_kernelTables[GetSupportedIntrinsicType()],
     };
+    ret.UpdateVisibleRegion(*vih);
+
+    // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
+    // DIBs with FourCC, such as RGB48 and RGB64, are always top-down
+    // AviSynth+'s RGB frames are bottom-up, so we invert the DIB if it's needed
+    const bool isInverted = (ret.bmi.biCompression == BI_RGB && ret.bmi.biHeight < 0) || ret.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB48 || ret.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB64;
+    ret.inputPlan = GetBufferPlan(ret, ret.sourceLeft, ret.sourceTop, ret.videoInfo.ComponentSize(), isInverted);
+    // CheckTransform() only accepts the output media types whose rcTarget is aligned for the stores of the kernels
+    ret.outputPlan = GetBufferPlan(ret, ret.targetLeft, ret.targetTop, ret.videoInfo.ComponentSize(), isInverted);
 
     if (SUCCEEDED(CheckVideoInfo2Type(&mediaType))) {
         const VIDEOINFOHEADER2 *vih2 = reinterpret_cast<VIDEOINFOHEADER2 *>(mediaType.pbFormat);
@@ -83,11 +145,11 @@ auto Format::WriteSample(const VideoFormat &videoFormat, const PVideoFrame &srcF
     const std::array srcSlices { srcFrame->GetReadPtr(PLANAR_Y), srcFrame->GetReadPtr(PLANAR_U), srcFrame->GetReadPtr(PLANAR_V) };
     const std::array srcStrides { srcFrame->GetPitch(PLANAR_Y), srcFrame->GetPitch(PLANAR_U), srcFrame->GetPitch(PLANAR_V) };
 
-    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, srcFrame->GetRowSize(), srcFrame->GetHeight());
+    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, srcFrame->GetRowSize(), srcFrame->GetHeight(), MainFrameServer::GetInstance().GetScriptVideoInfo());
 }
 
 auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> PVideoFrame {
-    PVideoFrame newFrame = AVSF_AVS_API->NewVideoFrame(videoFormat.videoInfo, static_cast<int>(_vectorSize));
+    PVideoFrame newFrame = AVSF_AVS_API->NewVideoFrame(videoFormat.videoInfo, videoFormat.kernels->vectorSize);
 
     const std::array dstSlices { newFrame->GetWritePtr(PLANAR_Y), newFrame->GetWritePtr(PLANAR_U), newFrame->GetWritePtr(PLANAR_V) };
     const std::array dstStrides { newFrame->GetPitch(PLANAR_Y), newFrame->GetPitch(PLANAR_U), newFrame->GetPitch(PLANAR_V) };
@@ -98,162 +160,303 @@ auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer)
 }
 
 auto Format::CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void {
-    const int srcMainPlaneRowSize = frameWidth;
-    // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
-    int srcMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.ComponentSize() * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(srcMainPlaneRowSize <= srcMainPlaneStride);
-    ASSERT(height == abs(videoFormat.bmi.biHeight));
-    const int srcMainPlaneSize = srcMainPlaneStride * height;
-    const BYTE *srcMainPlane = srcBuffer;
-    const int srcUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
+    const KernelTable &kernels = *videoFormat.kernels;
+    const bool isBitPacked = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED;
+    // for the bit packed formats, frameWidth is still the row size of AviSynth+'s Y plane
+    const int srcMainPlaneRowSize = isBitPacked ? DivideRoundUp(frameWidth / videoFormat.videoInfo.ComponentSize(), V210_BLOCK_PIXELS) * V210_BLOCK_SIZE : frameWidth;
+    // the strides, the offsets of the visible region and the row order have been worked out from the media type
+    const VideoFormat::BufferPlan &srcPlan = videoFormat.inputPlan;
+    const int srcMainPlaneStride = srcPlan.mainPlaneStride;
+    const BYTE *srcMainPlane = srcBuffer + srcPlan.planeOffsets[0];
+    ASSERT(srcMainPlaneRowSize <= abs(srcMainPlaneStride));
+    ASSERT(height == videoFormat.videoInfo.height);
+
+    // RGB48 and RGB64 have R-G-B order, which is swapped to B-G-R in the same pass as the copy
+    const bool isRedBlueSwapNeeded = videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB48 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB64;
+
+    // P010, P210 and P410 have the samples aligned to the most significant bits, which are right shifted in the same pass as the copy
+    const bool isRightShiftNeeded = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.BitsPerComponent() == 10;
+    // ordinary loads from write-combined or uncached memory are extremely slow, so such source is streamed through a cacheable bounce buffer
+    const bool isStreamLoad = videoFormat.inputBufferTemporalFlags == 0b11 && IsStreamingAligned(videoFormat, srcMainPlane, srcMainPlaneStride);
+
+    ForEachStripe(videoFormat, srcMainPlaneStride, height, [&](int mainFirstRow, int mainRows, int uvFirstRow, int uvRows) -> void {
+        const BYTE *srcMainStripe = srcMainPlane + static_cast<ptrdiff_t>(mainFirstRow) * srcMainPlaneStride;
+        const std::array dstStripes { dstSlices[0] + mainFirstRow * dstStrides[0], dstSlices[1] + uvFirstRow * dstStrides[1], dstSlices[2] + uvFirstRow * dstStrides[2] };
+
+        if (isRightShiftNeeded) {
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                kernels.rightShiftFunc(bandSrc, bandSrcStride, dstStripes[0] + bandFirstRow * dstStrides[0], dstStrides[0], srcMainPlaneRowSize, bandHeight);
+            });
+        } else if (isRedBlueSwapNeeded) {
+            const auto swapRedBlueFunc = videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.swapRedBlue48Func : kernels.swapRedBlue64Func;
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                swapRedBlueFunc(bandSrc, bandSrcStride, dstStripes[0] + bandFirstRow * dstStrides[0], dstStrides[0], srcMainPlaneRowSize, bandHeight);
+            });
+        } else if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
+                   (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && !isBitPacked && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                AVSF_AVS_API->BitBlt(dstStripes[0] + bandFirstRow * dstStrides[0], dstStrides[0], bandSrc, bandSrcStride, srcMainPlaneRowSize, bandHeight);
+            });
+        }
 
-    // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
-    // AviSynth+'s conversion functions assume input DIB being bottom-up, so we invert the DIB if it's needed
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight < 0) {
-        srcMainPlane += static_cast<size_t>(srcMainPlaneSize) - srcMainPlaneStride;
-        srcMainPlaneStride = -srcMainPlaneStride;
+        switch (videoFormat.pixelFormat->srcPlanesLayout) {
+        case PlanesLayout::ALL_PLANES_INTERLEAVED:
+            if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR && videoFormat.pixelFormat->subsampleWidthRatio == 2) {
+                decltype(kernels.deinterleaveY216Func) deinterleaveYUYVFunc;
+                if (videoFormat.videoInfo.ComponentSize() == 1) {
+                    deinterleaveYUYVFunc = kernels.deinterleaveUYVYFunc;
+                } else if (videoFormat.videoInfo.BitsPerComponent() == 10) {
+                    deinterleaveYUYVFunc = kernels.deinterleaveY210Func;
+                } else {
+                    deinterleaveYUYVFunc = kernels.deinterleaveY216Func;
+                }
+
+                // srcMainPlaneRowSize is the row size of the Y plane, while each pixel also carries half a U or V sample
+                ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize * 2, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                    deinterleaveYUYVFunc(bandSrc, bandSrcStride, OffsetRows(dstStripes, dstStrides, bandFirstRow), dstStrides, srcMainPlaneRowSize * 2, bandHeight);
+                });
+            } else if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR && videoFormat.videoInfo.ComponentSize() == 1) {
+                // AYUV has the same layout as RGB32, with V, U and Y in place of B, G and R
+                const std::array vuyaSlices { dstStripes[2], dstStripes[1], dstStripes[0] };
+                const std::array vuyaStrides { dstStrides[2], dstStrides[1], dstStrides[0] };
+
+                ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize * 4, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                    kernels.deinterleaveRGBC1Func(bandSrc, bandSrcStride, OffsetRows(vuyaSlices, vuyaStrides, bandFirstRow), vuyaStrides, srcMainPlaneRowSize * 4, bandHeight);
+                });
+            } else if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
+                const std::array yuvaSlices { dstStripes[1], dstStripes[0], dstStripes[2] };
+                const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
+
+                if (videoFormat.videoInfo.BitsPerComponent() == 10) {
+                    ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize * 2, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                        kernels.deinterleaveY410Func(bandSrc, bandSrcStride, OffsetRows(yuvaSlices, yuvaStrides, bandFirstRow), yuvaStrides, srcMainPlaneRowSize * 2, bandHeight);
+                    });
+                } else {
+                    ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize * 4, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                        kernels.deinterleaveY416Func(bandSrc, bandSrcStride, OffsetRows(yuvaSlices, yuvaStrides, bandFirstRow), yuvaStrides, srcMainPlaneRowSize * 4, bandHeight);
+                    });
+                }
+            }
+            break;
+
+        case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
+            const int srcUVStride = srcPlan.uvPlaneStride;
+            const BYTE *srcUVStart = srcBuffer + srcPlan.planeOffsets[1] + static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+            const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
+
+            decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
+            if (videoFormat.videoInfo.ComponentSize() == 1) {
+                deinterleaveUVFunc = kernels.deinterleaveUVC1Func;
+            } else if (isRightShiftNeeded) {
+                deinterleaveUVFunc = kernels.deinterleaveUVC2ShiftFunc;
+            } else {
+                deinterleaveUVFunc = kernels.deinterleaveUVC2Func;
+            }
+            ReadInBands(videoFormat, srcUVStart, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                deinterleaveUVFunc(bandSrc, bandSrcStride, { dstStripes[1] + bandFirstRow * dstStrides[1], dstStripes[2] + bandFirstRow * dstStrides[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, bandHeight);
+            });
+        } break;
+
+        case PlanesLayout::ALL_PLANES_SEPARATE: {
+            const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
+            const int srcUVStride = srcPlan.uvPlaneStride;
+            const BYTE *srcUVPlane1 = srcBuffer + srcPlan.planeOffsets[1];
+            const BYTE *srcUVPlane2 = srcBuffer + srcPlan.planeOffsets[2];
+
+            const BYTE *srcU;
+            const BYTE *srcV;
+            if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
+                srcU = srcUVPlane2;
+                srcV = srcUVPlane1;
+            } else {
+                srcU = srcUVPlane1;
+                srcV = srcUVPlane2;
+            }
+            srcU += static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+            srcV += static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+
+            ReadInBands(videoFormat, srcU, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                AVSF_AVS_API->BitBlt(dstStripes[1] + bandFirstRow * dstStrides[1], dstStrides[1], bandSrc, bandSrcStride, srcUVRowSize, bandHeight);
+            });
+            ReadInBands(videoFormat, srcV, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                AVSF_AVS_API->BitBlt(dstStripes[2] + bandFirstRow * dstStrides[2], dstStrides[2], bandSrc, bandSrcStride, srcUVRowSize, bandHeight);
+            });
+        } break;
+
+        case PlanesLayout::ALL_PLANES_BIT_PACKED:
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                kernels.unpackV210Func(bandSrc, bandSrcStride, OffsetRows(dstStripes, dstStrides, bandFirstRow), dstStrides, frameWidth / videoFormat.videoInfo.ComponentSize(), bandHeight);
+            });
+            break;
+        }
+    });
+}
+
+auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height, const VideoInfo &srcVideoInfo) -> void {
+    const KernelTable &kernels = *videoFormat.kernels;
+    // the script output of higher bit depth is reduced to the output format with ordered dither in the same pass as the interleaving
+    const bool isBitDepthReduced = srcVideoInfo.BitsPerComponent() > videoFormat.videoInfo.BitsPerComponent();
+    // planar YUV script output is converted to RGB32 in the same pass as the copy
+    const bool isYUVToRGB = srcVideoInfo.IsYUV() && videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB32;
+
+    int srcSubsampleWidthRatio = 1;
+    int srcSubsampleHeightRatio = 1;
+    if (srcVideoInfo.IsPlanar() && srcVideoInfo.IsYUV() && !srcVideoInfo.IsY()) {
+        srcSubsampleWidthRatio = 1 << srcVideoInfo.GetPlaneWidthSubsampling(PLANAR_U);
+        srcSubsampleHeightRatio = 1 << srcVideoInfo.GetPlaneHeightSubsampling(PLANAR_U);
+    }
+    // chroma of different subsampling is resampled to the semi-planar output in the same pass as the interleaving
+    const bool isChromaResampled = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED &&
+        (srcSubsampleWidthRatio != videoFormat.pixelFormat->subsampleWidthRatio || srcSubsampleHeightRatio != videoFormat.pixelFormat->subsampleHeightRatio);
+
+    if (isBitDepthReduced) {
+        // the reduction only happens from the 16-bit containers
+        frameWidth = frameWidth / 2 * videoFormat.videoInfo.ComponentSize();
+    } else if (isYUVToRGB) {
+        // from the row size of the 8-bit luma plane to 4 bytes per pixel
+        frameWidth *= 4;
     }
 
-    if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
-        (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
-        AVSF_AVS_API->BitBlt(dstSlices[0], dstStrides[0], srcMainPlane, srcMainPlaneStride, srcMainPlaneRowSize, height);
+    const bool isBitPacked = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED;
+    const int dstMainPlaneRowSize = isBitPacked ? DivideRoundUp(frameWidth / videoFormat.videoInfo.ComponentSize(), V210_BLOCK_PIXELS) * V210_BLOCK_SIZE : frameWidth;
+    // the frame is written to the region of rcTarget, which has been located from the media type
+    VideoFormat::BufferPlan dstPlan = videoFormat.outputPlan;
+    ASSERT(dstMainPlaneRowSize <= abs(dstPlan.mainPlaneStride));
+    ASSERT(height == videoFormat.videoInfo.height);
+
+    // unlike AviSynth+'s RGB frames, YUV frames are top-down, so the rows of RGB32 are in the opposite order of the plan
+    if (isYUVToRGB) {
+        dstPlan.planeOffsets[0] += static_cast<ptrdiff_t>(height - 1) * dstPlan.mainPlaneStride;
+        dstPlan.mainPlaneStride = -dstPlan.mainPlaneStride;
+    }
+    const int dstMainPlaneStride = dstPlan.mainPlaneStride;
+    BYTE *dstMainPlane = dstBuffer + dstPlan.planeOffsets[0];
+
+    // AviSynth+'s B-G-R order is swapped to R-G-B for RGB48 and RGB64 in the same pass as the copy
+    const bool isRedBlueSwapNeeded = videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB48 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB64;
+
+    // P010, P210 and P410 expect the samples aligned to the most significant bits, which are left shifted in the same pass as the copy
+    const bool isLeftShiftNeeded = !isBitDepthReduced && videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.BitsPerComponent() == 10;
+    // reading back from write-combined memory is extremely slow, so such destination is only written, and with non-temporal stores when possible
+    const bool isNonTemporal = isLeftShiftNeeded && videoFormat.outputBufferTemporalFlags == 0b111 && IsStreamingAligned(videoFormat, dstMainPlane, dstMainPlaneStride);
+
+    YUVToRGBCoefficients yuvToRGBCoeffs {};
+    decltype(kernels.yuvToRGB32Func) yuvToRGBFunc = nullptr;
+    if (isYUVToRGB) {
+        yuvToRGBCoeffs = GetYUVToRGBCoefficients(videoFormat);
+        yuvToRGBFunc = srcSubsampleWidthRatio == 1 ? kernels.yuvToRGB32Func : kernels.yuvToRGB32SubsampledFunc;
     }
 
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
-            const std::array yuvaSlices { dstSlices[1], dstSlices[0], dstSlices[2] };
-            const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
+    ForEachStripe(videoFormat, dstMainPlaneStride, height, [&](int mainFirstRow, int mainRows, int uvFirstRow, int uvRows) -> void {
+        BYTE *dstMainStripe = dstMainPlane + static_cast<ptrdiff_t>(mainFirstRow) * dstMainPlaneStride;
 
-            if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-                DeinterleaveY410(srcMainPlane, srcMainPlaneStride / 2, yuvaSlices, yuvaStrides, srcMainPlaneRowSize * 2, height);
-            } else {
-                _deinterleaveY416Func(srcMainPlane, srcMainPlaneStride, yuvaSlices, yuvaStrides, srcMainPlaneRowSize * 4, height);
-            }
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const BYTE *srcUVStart = srcMainPlane + srcMainPlaneSize;
-        const int srcUVStride = srcMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
-        if (videoFormat.videoInfo.ComponentSize() == 1) {
-            deinterleaveUVFunc = _deinterleaveUVC1Func;
-        } else {
-            deinterleaveUVFunc = _deinterleaveUVC2Func;
+        if (isYUVToRGB) {
+            // the stripes follow the rows of RGB32, so the source rows are located from the frame
+            yuvToRGBFunc(srcSlices, srcStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize / 4, mainRows, mainFirstRow, srcSubsampleHeightRatio, yuvToRGBCoeffs);
+            return;
         }
-        deinterleaveUVFunc(srcUVStart, srcUVStride, { dstSlices[1], dstSlices[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, srcUVHeight);
 
-        if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-            _rightShiftFunc(dstSlices[0], dstSlices[0], dstStrides[0], srcMainPlaneRowSize, height);
-            _rightShiftFunc(dstSlices[1], dstSlices[1], dstStrides[1], srcUVRowSize / 2, srcUVHeight);
-            _rightShiftFunc(dstSlices[2], dstSlices[2], dstStrides[2], srcUVRowSize / 2, srcUVHeight);
-        }
-    } break;
-
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVStride = srcMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const BYTE *srcUVPlane1 = srcMainPlane + srcMainPlaneSize;
-        const BYTE *srcUVPlane2 = srcUVPlane1 + srcMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        const BYTE *srcU;
-        const BYTE *srcV;
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
-            srcU = srcUVPlane2;
-            srcV = srcUVPlane1;
-        } else {
-            srcU = srcUVPlane1;
-            srcV = srcUVPlane2;
+        const std::array srcStripes { srcSlices[0] + mainFirstRow * srcStrides[0], srcSlices[1] + uvFirstRow * srcStrides[1], srcSlices[2] + uvFirstRow * srcStrides[2] };
+
+        if (isBitDepthReduced) {
+            (videoFormat.videoInfo.ComponentSize() == 1 ? kernels.reduceBitDepthC1Func : kernels.reduceBitDepthC2Func)(srcStripes[0], srcStrides[0], dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize / videoFormat.videoInfo.ComponentSize(), mainRows, srcVideoInfo.BitsPerComponent(), mainFirstRow);
+        } else if (isLeftShiftNeeded) {
+            (isNonTemporal ? kernels.leftShiftStreamFunc : kernels.leftShiftFunc)(srcStripes[0], srcStrides[0], dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+        } else if (isRedBlueSwapNeeded) {
+            (videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.swapRedBlue48Func : kernels.swapRedBlue64Func)(srcStripes[0], srcStrides[0], dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+        } else if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
+            (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && !isBitPacked && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
+            AVSF_AVS_API->BitBlt(dstMainStripe, dstMainPlaneStride, srcStripes[0], srcStrides[0], dstMainPlaneRowSize, mainRows);
         }
 
-        AVSF_AVS_API->BitBlt(dstSlices[1], dstStrides[1], srcU, srcUVStride, srcUVRowSize, srcUVHeight);
-        AVSF_AVS_API->BitBlt(dstSlices[2], dstStrides[2], srcV, srcUVStride, srcUVRowSize, srcUVHeight);
-    } break;
-    }
-}
-
-auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void {
-    const int dstMainPlaneRowSize = frameWidth;
-    int dstMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.ComponentSize() * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(dstMainPlaneRowSize <= dstMainPlaneStride);
-    ASSERT(height >= abs(videoFormat.bmi.biHeight));
-    const int dstMainPlaneSize = dstMainPlaneStride * height;
-    const int dstUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
-
-    BYTE *intermediateDstBufferBase = dstBuffer;
-    if (videoFormat.outputBufferTemporalFlags == 0b111) {
-        intermediateDstBufferBase = reinterpret_cast<BYTE *>(CoTaskMemAlloc(videoFormat.bmi.biSizeImage));
-    }
-    BYTE *dstMainPlane = intermediateDstBufferBase;
+        switch (videoFormat.pixelFormat->srcPlanesLayout) {
+        case PlanesLayout::ALL_PLANES_INTERLEAVED:
+            if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR && videoFormat.pixelFormat->subsampleWidthRatio == 2) {
+                decltype(kernels.interleaveY216Func) interleaveYUYVFunc;
+                if (videoFormat.videoInfo.ComponentSize() == 1) {
+                    interleaveYUYVFunc = kernels.interleaveUYVYFunc;
+                } else if (videoFormat.videoInfo.BitsPerComponent() == 10) {
+                    interleaveYUYVFunc = kernels.interleaveY210Func;
+                } else {
+                    interleaveYUYVFunc = kernels.interleaveY216Func;
+                }
+                interleaveYUYVFunc(srcStripes, srcStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize * 2, mainRows);
+            } else if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR && videoFormat.videoInfo.ComponentSize() == 1) {
+                // the alpha component of AYUV is filled the same way as RGB32
+                const std::array vuyaSlices { srcStripes[2], srcStripes[1], srcStripes[0] };
+                const std::array vuyaStrides { srcStrides[2], srcStrides[1], srcStrides[0] };
+
+                kernels.interleaveRGBC1Func(vuyaSlices, vuyaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize * 4, mainRows);
+            } else if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
+                const std::array yuvaSlices { srcStripes[1], srcStripes[0], srcStripes[2] };
+                const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
+
+                if (videoFormat.videoInfo.BitsPerComponent() == 10) {
+                    kernels.interleaveY410Func(yuvaSlices, yuvaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize * 2, mainRows);
+                } else {
+                    kernels.interleaveY416Func(yuvaSlices, yuvaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize * 4, mainRows);
+                }
+            }
+            break;
 
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight < 0) {
-        dstMainPlane += static_cast<size_t>(dstMainPlaneSize) - dstMainPlaneStride;
-        dstMainPlaneStride = -dstMainPlaneStride;
-    }
+        case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
+            const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
+            const int dstUVStride = dstPlan.uvPlaneStride;
+            BYTE *dstUVPlane = dstBuffer + dstPlan.planeOffsets[1];
+            BYTE *dstUVStart = dstUVPlane + static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
 
-    if ((videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_INTERLEAVED) ||
-        (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED && videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR)) {
-        AVSF_AVS_API->BitBlt(dstMainPlane, dstMainPlaneStride, srcSlices[0], srcStrides[0], dstMainPlaneRowSize, height);
-    }
+            if (isBitDepthReduced) {
+                (videoFormat.videoInfo.ComponentSize() == 1 ? kernels.interleaveUVReduceC1Func : kernels.interleaveUVReduceC2Func)(srcStripes[1], srcStripes[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize / 2 / videoFormat.videoInfo.ComponentSize(), uvRows, srcVideoInfo.BitsPerComponent(), uvFirstRow);
+                break;
+            }
 
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_PLANAR) {
-            const std::array yuvaSlices { srcSlices[1], srcSlices[0], srcSlices[2] };
-            const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
+            if (isChromaResampled) {
+                // the stripes follow the chroma rows of the output, so the source rows are located from the frame
+                ResampleInterleaveUV(videoFormat, srcSlices, srcStrides, srcSubsampleWidthRatio, srcSubsampleHeightRatio, dstUVPlane, dstUVStride,
+                                     dstMainPlaneRowSize / videoFormat.videoInfo.ComponentSize(), height, videoFormat.videoInfo.ComponentSize(), isLeftShiftNeeded, uvFirstRow, uvRows);
+                break;
+            }
 
-            if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-                InterleaveY410(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride / 2, dstMainPlaneRowSize * 2, height);
+            decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
+            if (videoFormat.videoInfo.ComponentSize() == 1) {
+                interleaveUVFunc = kernels.interleaveUVC1Func;
+            } else if (isNonTemporal) {
+                interleaveUVFunc = kernels.interleaveUVC2ShiftStreamFunc;
+            } else if (isLeftShiftNeeded) {
+                interleaveUVFunc = kernels.interleaveUVC2ShiftFunc;
             } else {
-                _interleaveY416Func(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize * 4, height);
+                interleaveUVFunc = kernels.interleaveUVC2Func;
             }
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVStart = dstMainPlane + dstMainPlaneSize;
-        const int dstUVStride = dstMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
-        if (videoFormat.videoInfo.ComponentSize() == 1) {
-            interleaveUVFunc = _interleaveUVC1Func;
-        } else {
-            interleaveUVFunc = _interleaveUVC2Func;
-        }
-        interleaveUVFunc(srcSlices[1], srcSlices[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, dstUVHeight);
-
-        if (videoFormat.videoInfo.BitsPerComponent() == 10) {
-            _leftShiftFunc(dstMainPlane, dstBuffer, dstMainPlaneStride, dstMainPlaneRowSize, height + dstUVHeight);
-            if (videoFormat.outputBufferTemporalFlags == 0b111) {
-                CoTaskMemFree(intermediateDstBufferBase);
+            interleaveUVFunc(srcStripes[1], srcStripes[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, uvRows);
+        } break;
+
+        case PlanesLayout::ALL_PLANES_SEPARATE: {
+            const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
+            BYTE *dstUVPlane1 = dstBuffer + dstPlan.planeOffsets[1];
+            BYTE *dstUVPlane2 = dstBuffer + dstPlan.planeOffsets[2];
+            const int dstUVStride = dstPlan.uvPlaneStride;
+
+            BYTE *dstU;
+            BYTE *dstV;
+            if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
+                dstU = dstUVPlane2;
+                dstV = dstUVPlane1;
+            } else {
+                dstU = dstUVPlane1;
+                dstV = dstUVPlane2;
             }
-        }
-    } break;
-
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVPlane1 = dstMainPlane + dstMainPlaneSize;
-        BYTE *dstUVPlane2 = dstUVPlane1 + dstMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-        const int dstUVStride = dstMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        BYTE *dstU;
-        BYTE *dstV;
-        if (videoFormat.pixelFormat->frameServerFormatId & VideoInfo::CS_VPlaneFirst) {
-            dstU = dstUVPlane2;
-            dstV = dstUVPlane1;
-        } else {
-            dstU = dstUVPlane1;
-            dstV = dstUVPlane2;
-        }
+            dstU += static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
+            dstV += static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
 
-        AVSF_AVS_API->BitBlt(dstU, dstUVStride, srcSlices[1], srcStrides[1], dstUVRowSize, dstUVHeight);
-        AVSF_AVS_API->BitBlt(dstV, dstUVStride, srcSlices[2], srcStrides[2], dstUVRowSize, dstUVHeight);
-    } break;
-    }
+            AVSF_AVS_API->BitBlt(dstU, dstUVStride, srcStripes[1], srcStrides[1], dstUVRowSize, uvRows);
+            AVSF_AVS_API->BitBlt(dstV, dstUVStride, srcStripes[2], srcStrides[2], dstUVRowSize, uvRows);
+        } break;
+
+        case PlanesLayout::ALL_PLANES_BIT_PACKED:
+            kernels.packV210Func(srcStripes, srcStrides, dstMainStripe, dstMainPlaneStride, frameWidth / videoFormat.videoInfo.ComponentSize(), mainRows);
+            break;
+        }
+    });
 }
 
 }
\ No newline at end of file
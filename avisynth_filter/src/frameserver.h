@@ -70,6 +70,7 @@ public:
     constexpr auto GetSourceAvgFrameDuration() const -> REFERENCE_TIME { return _sourceAvgFrameDuration; }
     constexpr auto GetSourceAvgFrameRate() const -> int { return _sourceAvgFrameRate; }
     constexpr auto GetScriptAvgFrameDuration() const -> REFERENCE_TIME { return _scriptAvgFrameDuration; }
+    constexpr auto GetScriptVideoInfo() const -> const VideoInfo & { return _scriptVideoInfo; }
     auto GetErrorString() const -> std::optional<std::string>;
 
 private:
@@ -11,8 +11,21 @@ namespace {
 
 const GUID MEDIASUBTYPE_I420                                  = FOURCCMap('024I');
 const GUID MEDIASUBTYPE_YV24                                  = FOURCCMap('42VY');
+const GUID MEDIASUBTYPE_NV24                                  = FOURCCMap('42VN');
+const GUID MEDIASUBTYPE_P410                                  = FOURCCMap('014P');
+const GUID MEDIASUBTYPE_P416                                  = FOURCCMap('614P');
 const GUID MEDIASUBTYPE_Y410                                  = FOURCCMap('014Y');
 const GUID MEDIASUBTYPE_Y416                                  = FOURCCMap('614Y');
+const GUID MEDIASUBTYPE_V210                                  = FOURCCMap('012v');
+const GUID MEDIASUBTYPE_Y210                                  = FOURCCMap('012Y');
+const GUID MEDIASUBTYPE_Y216                                  = FOURCCMap('612Y');
+// FourCCs of FFmpeg's RGB48LE and RGBA64LE, both in R-G-B(-A) order
+const GUID MEDIASUBTYPE_RGB48                                 = FOURCCMap('0BGR');
+const GUID MEDIASUBTYPE_RGB64                                 = FOURCCMap('@ABR');
+
+// DXVA_VideoTransferMatrix has no BT.2020 value. Decoders put MFVideoTransferMatrix_BT2020_10 and _12 in the same field
+constexpr const UINT DXVA_VIDEO_TRANSFER_MATRIX_BT2020_10     = 4;
+constexpr const UINT DXVA_VIDEO_TRANSFER_MATRIX_BT2020_12     = 5;
 
 #define SETTINGS_NAME_SUFFIX                                    " Settings"
 #define STATUS_NAME_SUFFIX                                      " Status"
@@ -62,6 +75,47 @@ constexpr const int NUM_FRAMES_FOR_INFINITE_STREAM            = 10810800;
  */
 constexpr const int MEDIA_SAMPLE_STRIDE_ALGINMENT             = 32;
 
+/*
+ * size of the cacheable buffer that the rows of write-combined or uncached input samples are streamed into before conversion.
+ * Small enough to stay in L2 cache.
+ */
+constexpr const int BOUNCE_BUFFER_SIZE                        = 64 * 1024;
+
+/*
+ * number of rows per stripe when converting between media samples and frames.
+ * 0 derives the stripe height from the size of the L2 cache, negative converts one whole plane at a time.
+ * Since every conversion is a single pass over each plane, striping only pays off on CPUs with small last level cache,
+ * thus disabled by default.
+ */
+constexpr const int STRIPE_SIZE                               = -1;
+constexpr const int FALLBACK_L2_CACHE_SIZE                    = 256 * 1024;
+
+/*
+ * frame conversion is split into row ranges of at least this many rows, each run by a worker of the conversion pool.
+ * Frames with fewer than twice the number of rows are converted on the calling thread.
+ */
+constexpr const int MIN_ROWS_PER_CONVERSION_TASK              = 256;
+
+/*
+ * number of timed runs of each candidate of the kernel autotuning, and of each kernel and resolution in the benchmark of kernel_test,
+ * after one untimed warm-up run.
+ */
+constexpr const int BENCHMARK_ITERATIONS                      = 10;
+
+/*
+ * stripe sizes tried by the kernel autotuning on each supported tier, with the same meaning as STRIPE_SIZE.
+ * The autotuning only runs when the KernelAutotune setting is enabled, once for each pair of input and output formats and resolutions.
+ * The winner is saved as the KernelPlan_ setting of the pair, which is loaded instead of tuning again.
+ */
+constexpr const std::array<int, 4> AUTOTUNE_STRIPE_SIZES      = { 0, 16, 64, -1 };
+
+/*
+ * longest time the kernel autotuning may hold up StartStreaming().
+ * The total is estimated from one copy in each direction before tuning, and the tuning is skipped if the estimate is over the budget.
+ * Since the estimate uses the fastest tier, the tuning is also abandoned as soon as it runs past the budget. Neither case saves a plan.
+ */
+constexpr const std::chrono::milliseconds AUTOTUNE_TIME_BUDGET(1000);
+
 /*
  * AviSynth+ and VapourSynth frame property names
  * The ones prefixed with "AVSF_" are specific private properties of this filter, both variants
@@ -76,7 +130,13 @@ constexpr const char *FRAME_PROP_NAME_TYPE_SPECIFIC_FLAGS     = "AVSF_TypeSpecif
 constexpr const WCHAR *REGISTRY_KEY_NAME_PREFIX               = L"Software\\AviSynthFilter\\";
 constexpr const WCHAR *SETTING_NAME_SCRIPT_FILE               = L"ScriptFile";
 constexpr const WCHAR *SETTING_NAME_LOG_FILE                  = L"LogFile";
+constexpr const WCHAR *SETTING_NAME_KERNEL_AUTOTUNE           = L"KernelAutotune";
+constexpr const WCHAR *SETTING_NAME_KERNEL_PLAN_PREFIX        = L"KernelPlan_";
 constexpr const WCHAR *SETTING_NAME_INPUT_FORMAT_PREFIX       = L"InputFormat_";
+constexpr const WCHAR *SETTING_NAME_STRIPE_SIZE_PREFIX        = L"StripeSize_";
+constexpr const WCHAR *SETTING_NAME_PARALLEL_CONVERSION       = L"ParallelConversion";
+constexpr const WCHAR *SETTING_NAME_MIN_ROWS_PER_TASK         = L"MinRowsPerConversionTask";
+constexpr const WCHAR *SETTING_NAME_RGB32_OUTPUT              = L"RGB32Output";
 constexpr const WCHAR *SETTING_NAME_REMOTE_CONTROL            = L"RemoteControl";
 constexpr const WCHAR *SETTING_NAME_INITIAL_SRC_BUFFER        = L"InitialSrcBuffer";
 constexpr const WCHAR *SETTING_NAME_MIN_EXTRA_SRC_BUFFER      = L"MinExtraSrcBuffer";
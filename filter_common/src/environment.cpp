@@ -49,7 +49,11 @@ Environment::Environment()
         }
     }
 
-    Log(L"Active CPU feature: %ls", IsSupportAVX2() ? L"AVX2" : (IsSupportSSE4() ? L"SSE4" : L"Basic"));
+    DetectCPUFeatures();
+    Log(L"Active CPU feature: %ls", IsSupportAVX512() ? L"AVX-512" : (IsSupportAVX2() ? L"AVX2" : (IsSupportSSE4() ? L"SSE4" : L"Basic")));
+
+    DetectProcessorTopology();
+    Log(L"L2 cache size: %d physical cores: %d", _l2CacheSize, _numPhysicalCores);
 }
 
 Environment::~Environment() {
@@ -70,7 +74,7 @@ auto Environment::SetScriptPath(const std::filesystem::path &scriptPath) -> void
     _scriptPath = scriptPath;
 
     if (_useIni) {
-        _ini.SetValue(L"", SETTING_NAME_SCRIPT_FILE, _scriptPath.c_str());
+        _ini.SetValue(L"", SETTING_NAME_SCRIPT_FILE, _scriptPath.wstring().c_str());
     }
 }
 
@@ -99,6 +103,32 @@ auto Environment::SetInputFormatEnabled(std::wstring_view formatName, bool enabl
     }
 }
 
+auto Environment::GetStripeSize(std::wstring_view formatName) const -> int {
+    const auto iter = _stripeSizes.find(formatName);
+    return iter == _stripeSizes.end() ? STRIPE_SIZE : iter->second;
+}
+
+auto Environment::GetKernelPlan(std::wstring_view planName) const -> std::wstring {
+    const std::wstring settingName = std::format(L"{}{}", SETTING_NAME_KERNEL_PLAN_PREFIX, planName);
+
+    if (_useIni) {
+        return _ini.GetValue(L"", settingName.c_str(), L"");
+    }
+    return _registry.ReadString(settingName.c_str());
+}
+
+auto Environment::SetKernelPlan(std::wstring_view planName, std::wstring_view plan) -> void {
+    const std::wstring settingName = std::format(L"{}{}", SETTING_NAME_KERNEL_PLAN_PREFIX, planName);
+
+    // unlike the settings from the property page, the plans are saved right away
+    if (_useIni) {
+        _ini.SetValue(L"", settingName.c_str(), std::wstring(plan).c_str());
+        SaveSettingsToIni();
+    } else {
+        static_cast<void>(_registry.WriteString(settingName.c_str(), plan));
+    }
+}
+
 auto Environment::LoadSettingsFromIni() -> void {
     _scriptPath = _ini.GetValue(L"", SETTING_NAME_SCRIPT_FILE, L"");
 
@@ -107,6 +137,9 @@ auto Environment::LoadSettingsFromIni() -> void {
         if (_ini.GetBoolValue(L"", settingName.c_str(), true)) {
             _enabledInputFormats.emplace(format.name);
         }
+
+        const std::wstring stripeSettingName = std::format(L"{}{}", SETTING_NAME_STRIPE_SIZE_PREFIX, format.name);
+        _stripeSizes.emplace(format.name, static_cast<int>(_ini.GetLongValue(L"", stripeSettingName.c_str(), STRIPE_SIZE)));
     });
 
     _isRemoteControlEnabled = _ini.GetBoolValue(L"", SETTING_NAME_REMOTE_CONTROL, false);
@@ -118,6 +151,11 @@ auto Environment::LoadSettingsFromIni() -> void {
     _extraSrcBufferDecStep = _ini.GetLongValue(L"", SETTING_NAME_EXTRA_SRC_BUFFER_DEC_STEP, EXTRA_SRC_BUFFER_DEC_STEP);
     _extraSrcBufferIncStep = _ini.GetLongValue(L"", SETTING_NAME_EXTRA_SRC_BUFFER_INC_STEP, EXTRA_SRC_BUFFER_INC_STEP);
     ValidateExtraSrcBufferValues();
+
+    _isParallelConversionEnabled = _ini.GetBoolValue(L"", SETTING_NAME_PARALLEL_CONVERSION, true);
+    _minRowsPerConversionTask = std::max(static_cast<int>(_ini.GetLongValue(L"", SETTING_NAME_MIN_ROWS_PER_TASK, MIN_ROWS_PER_CONVERSION_TASK)), 1);
+    _isRGB32OutputEnabled = _ini.GetBoolValue(L"", SETTING_NAME_RGB32_OUTPUT, false);
+    _isKernelAutotuneEnabled = _ini.GetBoolValue(L"", SETTING_NAME_KERNEL_AUTOTUNE, false);
 }
 
 auto Environment::LoadSettingsFromRegistry() -> void {
@@ -128,6 +166,9 @@ auto Environment::LoadSettingsFromRegistry() -> void {
         if (_registry.ReadNumber(settingName.c_str(), 1) != 0) {
             _enabledInputFormats.emplace(format.name);
         }
+
+        const std::wstring stripeSettingName = std::format(L"{}{}", SETTING_NAME_STRIPE_SIZE_PREFIX, format.name);
+        _stripeSizes.emplace(format.name, static_cast<int>(_registry.ReadNumber(stripeSettingName.c_str(), STRIPE_SIZE)));
     });
 
     _isRemoteControlEnabled = _registry.ReadNumber(SETTING_NAME_REMOTE_CONTROL, 0) != 0;
@@ -139,6 +180,11 @@ auto Environment::LoadSettingsFromRegistry() -> void {
     _extraSrcBufferDecStep = _registry.ReadNumber(SETTING_NAME_EXTRA_SRC_BUFFER_DEC_STEP, EXTRA_SRC_BUFFER_DEC_STEP);
     _extraSrcBufferIncStep = _registry.ReadNumber(SETTING_NAME_EXTRA_SRC_BUFFER_INC_STEP, EXTRA_SRC_BUFFER_INC_STEP);
     ValidateExtraSrcBufferValues();
+
+    _isParallelConversionEnabled = _registry.ReadNumber(SETTING_NAME_PARALLEL_CONVERSION, 1) != 0;
+    _minRowsPerConversionTask = std::max(static_cast<int>(_registry.ReadNumber(SETTING_NAME_MIN_ROWS_PER_TASK, MIN_ROWS_PER_CONVERSION_TASK)), 1);
+    _isRGB32OutputEnabled = _registry.ReadNumber(SETTING_NAME_RGB32_OUTPUT, 0) != 0;
+    _isKernelAutotuneEnabled = _registry.ReadNumber(SETTING_NAME_KERNEL_AUTOTUNE, 0) != 0;
 }
 
 auto Environment::ValidateExtraSrcBufferValues() -> void {
@@ -149,12 +195,82 @@ auto Environment::ValidateExtraSrcBufferValues() -> void {
     _extraSrcBufferIncStep = std::max(_extraSrcBufferIncStep, 0);
 }
 
+auto Environment::DetectCPUFeatures() -> void {
+    const auto Cpuid = [](int leaf) -> std::array<uint32_t, 4> {
+        std::array<uint32_t, 4> ret;
+#ifdef _MSC_VER
+        __cpuidex(reinterpret_cast<int *>(ret.data()), leaf, 0);
+#else
+        __cpuid_count(leaf, 0, ret[0], ret[1], ret[2], ret[3]);
+#endif
+        return ret;
+    };
+    const auto IsAllBitsSet = [](uint32_t reg, std::initializer_list<int> bits) -> bool {
+        return std::ranges::all_of(bits, [reg](int bit) -> bool { return (reg & (1U << bit)) != 0; });
+    };
+
+    const uint32_t maxLeaf = Cpuid(0)[0];
+    const std::array<uint32_t, 4> leaf1 = Cpuid(1);
+    const std::array<uint32_t, 4> leaf7 = maxLeaf >= 7 ? Cpuid(7) : std::array<uint32_t, 4> {};
+
+    // SSSE3, SSE4.1 and SSE4.2
+    _isSupportSSE4 = IsAllBitsSet(leaf1[2], { 9, 19, 20 });
+
+    // the YMM and ZMM registers are only usable when the OS saves their states on context switch, which XGETBV reports once OSXSAVE is set
+    uint64_t enabledStates = 0;
+    if (IsAllBitsSet(leaf1[2], { 27 })) {
+#ifdef _MSC_VER
+        enabledStates = _xgetbv(0);
+#else
+        uint32_t eax;
+        uint32_t edx;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        enabledStates = static_cast<uint64_t>(edx) << 32 | eax;
+#endif
+    }
+    const bool isYMMStateEnabled = (enabledStates & 0b110) == 0b110;
+    const bool isZMMStateEnabled = (enabledStates & 0b11100110) == 0b11100110;
+
+    // FMA and AVX in leaf 1, BMI1, AVX2 and BMI2 in leaf 7
+    _isSupportAVX2 = _isSupportSSE4 && isYMMStateEnabled && IsAllBitsSet(leaf1[2], { 12, 28 }) && IsAllBitsSet(leaf7[1], { 3, 5, 8 });
+
+    // AVX-512 F, DQ, CD, BW and VL, plus VBMI for VPERMB
+    _isSupportAVX512 = _isSupportAVX2 && isZMMStateEnabled && IsAllBitsSet(leaf7[1], { 16, 17, 28, 30, 31 }) && IsAllBitsSet(leaf7[2], { 1 });
+}
+
+auto Environment::DetectProcessorTopology() -> void {
+    _l2CacheSize = FALLBACK_L2_CACHE_SIZE;
+    _numPhysicalCores = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+
+    DWORD bufferSize = 0;
+    GetLogicalProcessorInformation(nullptr, &bufferSize);
+    std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> processorInfos(bufferSize / sizeof(SYSTEM_LOGICAL_PROCESSOR_INFORMATION));
+    if (processorInfos.empty() || !GetLogicalProcessorInformation(processorInfos.data(), &bufferSize)) {
+        return;
+    }
+
+    bool isL2CacheFound = false;
+    int numPhysicalCores = 0;
+    for (const SYSTEM_LOGICAL_PROCESSOR_INFORMATION &info : processorInfos) {
+        if (info.Relationship == RelationProcessorCore) {
+            numPhysicalCores += 1;
+        } else if (!isL2CacheFound && info.Relationship == RelationCache && info.Cache.Level == 2 && (info.Cache.Type == CacheUnified || info.Cache.Type == CacheData)) {
+            _l2CacheSize = static_cast<int>(info.Cache.Size);
+            isL2CacheFound = true;
+        }
+    }
+
+    if (numPhysicalCores > 0) {
+        _numPhysicalCores = numPhysicalCores;
+    }
+}
+
 auto Environment::SaveSettingsToIni() const -> void {
     static_cast<void>(_ini.SaveFile(_iniPath.c_str()));
 }
 
 auto Environment::SaveSettingsToRegistry() const -> void {
-    static_cast<void>(_registry.WriteString(SETTING_NAME_SCRIPT_FILE, _scriptPath.c_str()));
+    static_cast<void>(_registry.WriteString(SETTING_NAME_SCRIPT_FILE, _scriptPath.wstring().c_str()));
     static_cast<void>(_registry.WriteNumber(SETTING_NAME_REMOTE_CONTROL, _isRemoteControlEnabled));
 
     std::ranges::for_each(
@@ -38,18 +38,30 @@ public:
     auto SetInputFormatEnabled(std::wstring_view formatName, bool enabled) -> void;
     constexpr auto IsRemoteControlEnabled() const -> bool { return _isRemoteControlEnabled; }
     auto SetRemoteControlEnabled(bool enabled) -> void;
-    constexpr auto IsSupportAVX2() const -> bool { return std::__isa_available >= __ISA_AVAILABLE_AVX2; }
-    constexpr auto IsSupportSSE4() const -> bool { return std::__isa_available >= __ISA_AVAILABLE_SSE42; }
+    constexpr auto IsSupportAVX512() const -> bool { return _isSupportAVX512; }
+    constexpr auto IsSupportAVX2() const -> bool { return _isSupportAVX2; }
+    constexpr auto IsSupportSSE4() const -> bool { return _isSupportSSE4; }
     constexpr auto GetInitialSrcBuffer() const -> int { return _initialSrcBuffer; }
     constexpr auto GetMinExtraSrcBuffer() const -> int { return _minExtraSrcBuffer; }
     constexpr auto GetMaxExtraSrcBuffer() const -> int { return _maxExtraSrcBuffer; }
     constexpr auto GetExtraSrcBufferDecStep() const -> int { return _extraSrcBufferDecStep; }
     constexpr auto GetExtraSrcBufferIncStep() const -> int { return _extraSrcBufferIncStep; }
+    auto GetStripeSize(std::wstring_view formatName) const -> int;
+    constexpr auto GetL2CacheSize() const -> int { return _l2CacheSize; }
+    constexpr auto GetNumPhysicalCores() const -> int { return _numPhysicalCores; }
+    constexpr auto IsParallelConversionEnabled() const -> bool { return _isParallelConversionEnabled; }
+    constexpr auto GetMinRowsPerConversionTask() const -> int { return _minRowsPerConversionTask; }
+    constexpr auto IsRGB32OutputEnabled() const -> bool { return _isRGB32OutputEnabled; }
+    constexpr auto IsKernelAutotuneEnabled() const -> bool { return _isKernelAutotuneEnabled; }
+    auto GetKernelPlan(std::wstring_view planName) const -> std::wstring;
+    auto SetKernelPlan(std::wstring_view planName, std::wstring_view plan) -> void;
 
 private:
     auto LoadSettingsFromIni() -> void;
     auto LoadSettingsFromRegistry() -> void;
     auto ValidateExtraSrcBufferValues() -> void;
+    auto DetectCPUFeatures() -> void;
+    auto DetectProcessorTopology() -> void;
     auto SaveSettingsToIni() const -> void;
     auto SaveSettingsToRegistry() const -> void;
 
@@ -67,6 +79,17 @@ private:
     int _maxExtraSrcBuffer;
     int _extraSrcBufferDecStep;
     int _extraSrcBufferIncStep;
+    std::map<std::wstring_view, int> _stripeSizes;
+    bool _isParallelConversionEnabled;
+    int _minRowsPerConversionTask;
+    bool _isRGB32OutputEnabled;
+    bool _isKernelAutotuneEnabled;
+
+    bool _isSupportSSE4 = false;
+    bool _isSupportAVX2 = false;
+    bool _isSupportAVX512 = false;
+    int _l2CacheSize;
+    int _numPhysicalCores;
 
     std::filesystem::path _logPath;
     FILE *_logFile = nullptr;
@@ -32,6 +32,7 @@ CSynthFilter::~CSynthFilter() {
     if (_numFilterInstances == 0) {
         _remoteControl.reset();
         frameHandler.reset();
+        Format::Uninitialize();
         AuxFrameServer::Destroy();
         MainFrameServer::Destroy();
         FrameServerCommon::Destroy();
@@ -94,15 +95,15 @@ auto CSynthFilter::CheckConnect(PIN_DIRECTION direction, IPin *pPin) -> HRESULT
                         return VFW_E_TYPE_NOT_ACCEPTED;
                     }
 
-                    // all media types that share the same frameserver format are acceptable for output pin connection
+                    // all media types that share the same frameserver format, or its reduced bit depth, are acceptable for output pin connection
                     const int scriptFormatId = AuxFrameServer::GetInstance().GetScriptPixelType();
-                    for (const Format::PixelFormat &frameServerPixelFormat : Format::LookupFrameServerFormatId(scriptFormatId)) {
-                        const CMediaType outputMediaType = AuxFrameServer::GetInstance().GenerateMediaType(frameServerPixelFormat, nextType);
+                    for (const Format::PixelFormat *frameServerPixelFormat : Format::LookupOutputFormats(scriptFormatId)) {
+                        const CMediaType outputMediaType = AuxFrameServer::GetInstance().GenerateMediaType(*frameServerPixelFormat, nextType);
                         _compatibleMediaTypes.emplace_back(nextTypePtr, optInputPixelFormat, outputMediaType, MediaTypeToPixelFormat(&outputMediaType));
                         if (std::ranges::find(_availableOutputMediaTypes, outputMediaType) == _availableOutputMediaTypes.end()) {
                             _availableOutputMediaTypes.emplace_back(outputMediaType);
                         }
-                        Environment::GetInstance().Log(L"Add compatible formats: input %5ls output %5ls", optInputPixelFormat->name, frameServerPixelFormat.name);
+                        Environment::GetInstance().Log(L"Add compatible formats: input %5ls output %5ls", optInputPixelFormat->name, frameServerPixelFormat->name);
                     }
                 }
             } else if (hr == VFW_E_ENUM_OUT_OF_SYNC) {
@@ -168,6 +169,12 @@ auto CSynthFilter::GetMediaType(int iPosition, CMediaType *pMediaType) -> HRESUL
 }
 
 auto CSynthFilter::CheckTransform(const CMediaType *mtIn, const CMediaType *mtOut) -> HRESULT {
+    // this is also reached from QueryAccept() of the output pin, which the downstream calls before attaching a new media type to the samples
+    if (!Format::IsTargetAligned(*mtOut)) {
+        Environment::GetInstance().Log(L"Reject output media type with unaligned rcTarget: %5ls", MediaTypeToPixelFormat(mtOut)->name);
+        return VFW_E_TYPE_NOT_ACCEPTED;
+    }
+
     return S_OK;
 }
 
@@ -235,7 +242,7 @@ auto CSynthFilter::CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin) -
 
                 bmi = Format::GetBitmapInfo(alignedMediaType);
                 bmi->biWidth = alignedStride;
-                bmi->biSizeImage = GetBitmapSize(bmi);
+                bmi->biSizeImage = Format::GetBitmapImageSize(*bmi);
 
                 if (m_pInput->QueryAccept(&alignedMediaType) == S_OK) {
                     hr = reinterpret_cast<IFilterGraph2 *>(m_pGraph)->ReconnectEx(m_pInput->GetConnected(), &alignedMediaType);
@@ -295,8 +302,14 @@ auto CSynthFilter::CompleteConnect(PIN_DIRECTION direction, IPin *pReceivePin) -
 
 auto CSynthFilter::StartStreaming() -> HRESULT {
     AuxFrameServer::GetInstance().ReloadScript(m_pInput->CurrentMediaType(), true);
+
     _inputVideoFormat = Format::GetVideoFormat(m_pInput->CurrentMediaType(), &AuxFrameServer::GetInstance());
     _outputVideoFormat = Format::GetVideoFormat(m_pOutput->CurrentMediaType(), &AuxFrameServer::GetInstance());
+    if (Environment::GetInstance().IsKernelAutotuneEnabled()) {
+        if (const std::optional<Format::KernelPlan> optKernelPlan = Format::AutotuneKernels(m_pInput->CurrentMediaType(), m_pOutput->CurrentMediaType(), &AuxFrameServer::GetInstance())) {
+            Format::ApplyKernelPlan(*optKernelPlan, _inputVideoFormat, _outputVideoFormat);
+        }
+    }
 
     if (Environment::GetInstance().IsRemoteControlEnabled()) {
         // remote control should start after the input video format is initialized
@@ -70,12 +70,13 @@ private:
         const Format::PixelFormat *outputPixelFormat;
     };
 
-    static auto InputToOutputMediaType(const AM_MEDIA_TYPE *mtIn) {
+    static auto InputToOutputMediaType(const AM_MEDIA_TYPE *mtIn) -> std::vector<CMediaType> {
         AuxFrameServer::GetInstance().ReloadScript(*mtIn, true);
         const int scriptFormatId = AuxFrameServer::GetInstance().GetScriptPixelType();
-        auto ret = Format::LookupFrameServerFormatId(scriptFormatId) | std::views::transform([mtIn](const Format::PixelFormat &pixelFormat) -> CMediaType {
-                       return AuxFrameServer::GetInstance().GenerateMediaType(pixelFormat, mtIn);
-                   });
+        std::vector<CMediaType> ret;
+        for (const Format::PixelFormat *pixelFormat : Format::LookupOutputFormats(scriptFormatId)) {
+            ret.emplace_back(AuxFrameServer::GetInstance().GenerateMediaType(*pixelFormat, mtIn));
+        }
         if (ret.empty()) {
             Environment::GetInstance().Log(L"Unable to find any supported pixel format for script pixel type %d", scriptFormatId);
         }
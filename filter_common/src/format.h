@@ -3,7 +3,9 @@
 #pragma once
 
 #include "environment.h"
+#include "simd.h"
 #include "util.h"
+#include "worker_pool.h"
 
 
 namespace SynthFilter {
@@ -31,6 +33,8 @@ public:
         ALL_PLANES_INTERLEAVED,
         MAIN_SEPARATE_SEC_INTERLEAVED,
         ALL_PLANES_SEPARATE,
+        // all planes packed together as bit fields across each block of pixels, such as v210
+        ALL_PLANES_BIT_PACKED,
     };
 
     struct PixelFormat {
@@ -53,6 +57,8 @@ public:
         int resourceId;
     };
 
+    struct KernelTable;
+
     struct VideoFormat {
         struct ColorSpaceInfo {
             std::optional<int> colorRange;
@@ -77,20 +83,73 @@ public:
          * bit 1 is set if the format requires bit shifting
          * bit 2 is set if the protection of the destination sample buffer has been queried
          * bit 3 is set if the protection of the destination sample buffer has PAGE_WRITECOMBINE
-         * when all bits are set, CopyToOutput() utilize an intermediate destination buffer
+         * when all bits are set, CopyToOutput() writes the destination buffer with non-temporal stores
          */
         int outputBufferTemporalFlags = 0;
 
+        /*
+         * bit 1 is set if the protection of the source sample buffer has been queried
+         * bit 2 is set if the protection of the source sample buffer has PAGE_WRITECOMBINE or PAGE_NOCACHE
+         * when all bits are set, CopyFromInput() reads the source buffer with streaming loads through a bounce buffer
+         * only the streaming thread sets the bits. They are cleared by GetVideoFormat(), which runs in StartStreaming() after every allocator change
+         */
+        int inputBufferTemporalFlags = 0;
+
+        /*
+         * top-left corner of rcSource in the input sample buffer, and of rcTarget in the output sample buffer
+         * the visible region can be smaller than the buffer, such as 1080 rows of H.264 decoded into a buffer of 1088
+         */
+        int sourceLeft = 0;
+        int sourceTop = 0;
+        int targetLeft = 0;
+        int targetTop = 0;
+
+        /*
+         * the sample buffer as located once from the media type, so that the copy of each frame only adds the rows of its stripes
+         * the offsets are relative to the start of the buffer and point to the first row copied of the visible region
+         * when the rows are inverted, the main plane starts from the last row in memory with negative stride
+         */
+        struct BufferPlan {
+            int mainPlaneStride = 0;
+            int uvPlaneStride = 0;
+            // main plane, followed by the UV planes in the order of the buffer, both pointing to the same plane when UV is interleaved
+            std::array<ptrdiff_t, 3> planeOffsets {};
+        };
+        BufferPlan inputPlan;
+        BufferPlan outputPlan;
+
+        // stripe height picked by the kernel autotuning for this format and resolution, which takes precedence over the StripeSize_ setting
+        std::optional<int> tunedStripeSize;
+
+        // kernels of the tier that the conversions of this format run on, either the best supported one or the winner of the kernel autotuning
+        const KernelTable *kernels = nullptr;
+
         auto GetCodecFourCC() const -> DWORD;
+        auto UpdateVisibleRegion(const VIDEOINFOHEADER &vih) -> void;
+    };
+
+    /*
+     * winner of the kernel autotuning for a pair of input and output formats and resolutions
+     * the stripe sizes have the same meaning as the StripeSize_ settings
+     */
+    struct KernelPlan {
+        int intrinsicType;
+        int inputStripeSize;
+        int outputStripeSize;
     };
 
     static auto Initialize() -> void;
+    static auto Uninitialize() -> void;
     static auto LookupMediaSubtype(const CLSID &mediaSubtype) -> const PixelFormat *;
     static auto LookupFrameServerFormatId(int frameServerFormatId) {
         return PIXEL_FORMATS | std::views::filter([frameServerFormatId](const PixelFormat &pixelFormat) -> bool {
                    return frameServerFormatId == pixelFormat.frameServerFormatId;
                });
     }
+    static auto LookupOutputFormats(int frameServerFormatId) -> std::vector<const PixelFormat *>;
+    static auto GetReducedFrameServerFormatId(int frameServerFormatId, int bitsPerComponent) -> std::optional<int>;
+    static auto GetResampledFrameServerFormatId(int frameServerFormatId, int subsampleWidthRatio, int subsampleHeightRatio) -> std::optional<int>;
+    static auto IsConvertibleToRGB32(int frameServerFormatId) -> bool;
 
     template <typename T, typename = std::enable_if_t<std::is_base_of_v<AM_MEDIA_TYPE, std::decay_t<T>>>>
     static constexpr auto GetBitmapInfo(T &mediaType) -> BITMAPINFOHEADER * {
@@ -105,12 +164,30 @@ public:
         return nullptr;
     }
 
+    static auto GetV210Stride(int width) -> int;
+    static auto GetBitmapImageSize(const BITMAPINFOHEADER &bmi) -> DWORD;
     static auto GetStrideAlignedMediaSampleSize(const AM_MEDIA_TYPE &mediaType, int strideAlignment) -> long;
+    static auto IsStreamingAligned(const VideoFormat &videoFormat, const BYTE *buffer, int stride) -> bool;
+    static auto GetPlaneColumnOffsets(const PixelFormat &pixelFormat, int column, int componentSize) -> std::array<int, 2>;
+    static auto IsTargetAligned(const AM_MEDIA_TYPE &mediaType) -> bool;
+    static auto GetBufferPlan(const VideoFormat &videoFormat, int left, int top, int componentSize, bool isInverted) -> VideoFormat::BufferPlan;
+    static auto ReadInBands(const VideoFormat &videoFormat, const BYTE *src, int srcStride, int rowSize, int height, bool isStreamLoad, const std::function<void(const BYTE *, int, int, int)> &bandFunc) -> void;
+    static auto ForEachStripe(const VideoFormat &videoFormat, int mainPlaneStride, int height, const std::function<void(int, int, int, int)> &stripeFunc) -> void;
+    static auto ResampleInterleaveUV(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, int srcSubsampleWidthRatio, int srcSubsampleHeightRatio, BYTE *dstUVPlane, int dstUVStride, int frameWidth, int height, int componentSize, bool isLeftShiftNeeded, int uvFirstRow, int uvRows) -> void;
     static auto GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat;
     static auto WriteSample(const VideoFormat &videoFormat, InputFrameType srcFrame, BYTE *dstBuffer) -> void;
     static auto CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> OutputFrameType;
     static auto CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void;
-    static auto CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void;
+    static auto CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height, const VideoInfoType &srcVideoInfo) -> void;
+    // picks the fastest tier and stripe sizes for the conversions of the media types, implemented in format_benchmark.cpp
+    static auto AutotuneKernels(const AM_MEDIA_TYPE &inputMediaType, const AM_MEDIA_TYPE &outputMediaType, const FrameServerBase *frameServerInstance) -> std::optional<KernelPlan>;
+    static auto ApplyKernelPlan(const KernelPlan &kernelPlan, VideoFormat &inputVideoFormat, VideoFormat &outputVideoFormat) -> void;
+    // compares the kernels and the frame copies of every supported tier with the Basic tier on random geometry and returns the number of failures
+    // only built into the kernel_test executable, implemented in kernel_test/src/format_fuzz.cpp
+    static auto RunKernelFuzz(int rounds) -> int;
+    // times the kernels and the whole frame copies on every supported tier and writes the results to outputPath as JSON
+    // only built into the kernel_test executable, implemented in kernel_test/src/kernel_benchmark.cpp
+    static auto RunBenchmark(const std::filesystem::path &outputPath) -> bool;
 
     static const std::vector<PixelFormat> PIXEL_FORMATS;
 
@@ -128,6 +205,7 @@ public:
 private:
     static inline const __m128i _UV_SHUFFLE_MASK_M128_C1  = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
     static inline const __m128i _UV_SHUFFLE_MASK_M128_C2  = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    static inline const __m128i _UV_INTERLEAVE_MASK_C1    = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
     static inline       __m256i _UV_SHUFFLE_MASK_M256_C1;
     static inline       __m256i _UV_SHUFFLE_MASK_M256_C2;
     static inline const __m128i _Y410_AND_MASK_1          = _mm_setr_epi32(1023, 1023, 1023, 1023);  // 10 bits of 1s at the least significant side
@@ -139,19 +217,185 @@ private:
     static inline const __m128i _Y416_SHUFFLE_MASK_M128   = _mm_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
     static inline       __m256i _Y416_SHUFFLE_MASK_M256;
     static inline const __m128i _RGB_SHUFFLE_MASK_M128_C1 = _mm_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    static inline const __m128i _RGBA64_SWAP_MASK         = _mm_setr_epi8(4, 5, 2, 3, 0, 1, 6, 7, 12, 13, 10, 11, 8, 9, 14, 15);
     static inline       __m256i _RGB_SHUFFLE_MASK_M256_C1;
+    static inline const __m128i _YUYV_SHUFFLE_MASK_C1     = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 5, 9, 13, 3, 7, 11, 15);
+    static inline const __m128i _UYVY_SHUFFLE_MASK_C1     = _mm_setr_epi8(1, 3, 5, 7, 9, 11, 13, 15, 0, 4, 8, 12, 2, 6, 10, 14);
+    static inline const __m128i _YUYV_SHUFFLE_MASK_C2     = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 10, 11, 6, 7, 14, 15);
+    static inline const __m128i _V210_UNPACK_Y_MASK_1     = _mm_setr_epi8(8, 9, 2, 3, -1, -1, 12, 13, 6, 7, -1, -1, -1, -1, -1, -1);
+    static inline const __m128i _V210_UNPACK_Y_MASK_2     = _mm_setr_epi8(-1, -1, -1, -1, 2, 3, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1);
+    static inline const __m128i _V210_UNPACK_UV_MASK_1    = _mm_setr_epi8(0, 1, 10, 11, -1, -1, -1, -1, -1, -1, 4, 5, 14, 15, -1, -1);
+    static inline const __m128i _V210_UNPACK_UV_MASK_2    = _mm_setr_epi8(-1, -1, -1, -1, 4, 5, -1, -1, 0, 1, -1, -1, -1, -1, -1, -1);
+    static inline const __m128i _V210_PACK_Y_MASK_1       = _mm_setr_epi8(-1, -1, -1, -1, 2, 3, -1, -1, -1, -1, -1, -1, 8, 9, -1, -1);
+    static inline const __m128i _V210_PACK_Y_MASK_2       = _mm_setr_epi8(0, 1, -1, -1, -1, -1, -1, -1, 6, 7, -1, -1, -1, -1, -1, -1);
+    static inline const __m128i _V210_PACK_Y_MASK_3       = _mm_setr_epi8(-1, -1, -1, -1, 4, 5, -1, -1, -1, -1, -1, -1, 10, 11, -1, -1);
+    static inline const __m128i _V210_PACK_UV_MASK_1      = _mm_setr_epi8(0, 1, -1, -1, -1, -1, -1, -1, 10, 11, -1, -1, -1, -1, -1, -1);
+    static inline const __m128i _V210_PACK_UV_MASK_2      = _mm_setr_epi8(-1, -1, -1, -1, 2, 3, -1, -1, -1, -1, -1, -1, 12, 13, -1, -1);
+    static inline const __m128i _V210_PACK_UV_MASK_3      = _mm_setr_epi8(8, 9, -1, -1, -1, -1, -1, -1, 4, 5, -1, -1, -1, -1, -1, -1);
     static constexpr const int  _UV_PERMUTE_INDEX         = 0b11011000;
     static inline       __m256i _FOUR_PERMUTE_INDEX;
+    static inline       __m512i _UV_PERMUTE_INDEX_M512_C1;
+    static inline       __m512i _UV_PERMUTE_INDEX_M512_C2;
+    static inline       __m512i _Y416_PERMUTE_INDEX_M512;
+    static inline       __m512i _RGB_PERMUTE_INDEX_M512_C1;
+    static inline       __m512i _UV_INTERLEAVE_INDEX_M512_C1_LO;
+    static inline       __m512i _UV_INTERLEAVE_INDEX_M512_C1_HI;
+    static inline       __m512i _UV_INTERLEAVE_INDEX_M512_C2_LO;
+    static inline       __m512i _UV_INTERLEAVE_INDEX_M512_C2_HI;
+    static inline       __m512i _QWORD_INDEX_M512;
+
+    // PSHUFB masks permuting the bytes of a 48-byte block, indexed by [destination 16-byte part][source 16-byte part]
+    using BlockShuffleMasks = std::array<std::array<__m128i, 3>, 3>;
+
+    static inline BlockShuffleMasks _RGB24_DEINTERLEAVE_MASKS;
+    static inline BlockShuffleMasks _RGB24_INTERLEAVE_MASKS;
+    static inline BlockShuffleMasks _RGB48_DEINTERLEAVE_MASKS;
+    static inline BlockShuffleMasks _RGB48_INTERLEAVE_MASKS;
+    static inline BlockShuffleMasks _RGB48_SWAP_MASKS;
+
+    // 4x4 Bayer matrix for the ordered dither of the bit depth reduction
+    static constexpr const std::array<std::array<int, 4>, 4> _BAYER_MATRIX { { { 0, 8, 2, 10 }, { 12, 4, 14, 6 }, { 3, 11, 1, 9 }, { 15, 7, 13, 5 } } };
+
+    /*
+     * YUV to RGB matrix in Q13 fixed point, for PMULHRSW on the samples left shifted by 6 bits.
+     * The products carry 4 fractional bits. Both chroma terms of G are subtracted.
+     */
+    struct YUVToRGBCoefficients {
+        int16_t lumaOffset;
+        int16_t luma;
+        int16_t crToR;
+        int16_t cbToG;
+        int16_t crToG;
+        int16_t cbToB;
+    };
+
+    static auto GetYUVToRGBCoefficients(const VideoFormat &videoFormat) -> YUVToRGBCoefficients;
+
+    // indexed by intrinsicType, same as the active CPU feature in the log
+    static constexpr const std::array<const char *, 4> INTRINSIC_TYPE_NAMES { "Basic", "SSE4", "AVX2", "AVX-512" };
+
+    // the kernels of each tier are instantiated in format_sse4.cpp, format_avx2.cpp and format_avx512.cpp, which are compiled for their instruction sets
+    static auto GetSupportedIntrinsicType() -> int;
+    static auto InitializeKernels(int intrinsicType) -> void;
+    static auto InitializeSSE4(KernelTable &kernels) -> void;
+    static auto InitializeAVX2(KernelTable &kernels) -> void;
+    static auto InitializeAVX512(KernelTable &kernels) -> void;
+
+    /*
+     * Timing shared by the kernel autotuning and the benchmark of kernel_test, implemented in format_benchmark.cpp.
+     * The frame copy buffers are a media sample and a frame of the same format and size, whose frame keeps the format of the sample,
+     * so neither CopyFromInput() nor CopyToOutput() reduces the bit depth, resamples the chroma or converts to RGB.
+     * Only the planar and semi-planar formats are supported, whose frames have the same three planes in every frame server.
+     */
+    struct BenchmarkStats {
+        double meanMicroseconds;
+        double stdDevMicroseconds;
+        double ticksPerRun;
+    };
+
+    struct FrameCopyBuffers {
+        BYTE *sample;
+        std::array<BYTE *, 3> frameSlices;
+        std::array<int, 3> frameStrides;
+        int frameWidth;
+        int height;
+    };
+
+    static auto GetBenchmarkStride(int rowSize) -> int;
+    static auto AllocateBenchmarkBuffer(std::vector<BYTE> &storage, size_t size) -> BYTE *;
+    static auto MeasureRuns(const std::function<void()> &run) -> BenchmarkStats;
+    static auto IsFrameCopySupported(const VideoFormat &videoFormat) -> bool;
+    static auto AllocateFrameCopyBuffers(const VideoFormat &videoFormat, std::vector<BYTE> &sampleStorage, std::array<std::vector<BYTE>, 3> &planeStorages) -> FrameCopyBuffers;
+    static auto MeasureCopyFromInput(const VideoFormat &videoFormat, const FrameCopyBuffers &buffers) -> BenchmarkStats;
+    static auto MeasureCopyToOutput(const VideoFormat &videoFormat, const FrameCopyBuffers &buffers) -> BenchmarkStats;
+
+    /*
+     * Index for VPERMB/VPERMW that gathers every numComponents-th element of the source vector together,
+     * so that each component occupies a consecutive block of the output vector.
+     */
+    template <typename Elem, int numElems, int numComponents>
+    static constexpr auto GeneratePermuteIndex() -> std::array<Elem, numElems> {
+        std::array<Elem, numElems> ret {};
+        for (int i = 0; i < numElems; ++i) {
+            ret[i] = static_cast<Elem>(i % (numElems / numComponents) * numComponents + i / (numElems / numComponents));
+        }
+        return ret;
+    }
+
+    /*
+     * Index for VPERMT2B/VPERMT2W that alternates elements from the two sources, starting from the element (half * numElems / 2).
+     * The element index of the second source is offset by numElems.
+     */
+    template <typename Elem, int numElems, int half>
+    static constexpr auto GenerateInterleaveIndex() -> std::array<Elem, numElems> {
+        std::array<Elem, numElems> ret {};
+        for (int i = 0; i < numElems; ++i) {
+            ret[i] = static_cast<Elem>(i % 2 * numElems + i / 2 + half * numElems / 2);
+        }
+        return ret;
+    }
+
+    /*
+     * srcByteOf maps each byte of the destination block to its byte in the source block.
+     * Each destination part ORs the shuffled vectors of all three source parts, thus bytes from the other source parts are zeroed in the mask.
+     */
+    template <typename SrcByteFunc>
+    static auto GenerateBlockShuffleMasks(SrcByteFunc srcByteOf) -> BlockShuffleMasks {
+        constexpr int partSize = sizeof(__m128i);
+        BlockShuffleMasks ret;
+
+        for (int dstPart = 0; dstPart < 3; ++dstPart) {
+            for (int srcPart = 0; srcPart < 3; ++srcPart) {
+                std::array<int8_t, partSize> mask;
+                for (int i = 0; i < partSize; ++i) {
+                    const int srcByte = srcByteOf(dstPart * partSize + i);
+                    mask[i] = static_cast<int8_t>(srcByte / partSize == srcPart ? srcByte % partSize : -1);
+                }
+                ret[dstPart][srcPart] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(mask.data()));
+            }
+        }
+
+        return ret;
+    }
+
+    // mask for the lowest numBytes bytes of a 512-bit vector, used for the masked loads and stores of the row tails
+    static constexpr auto TailMaskM512(int numBytes) -> __mmask64 {
+        if (numBytes <= 0) {
+            return 0;
+        }
+        if (numBytes >= static_cast<int>(sizeof(__m512i))) {
+            return ~0ULL;
+        }
+        return (1ULL << numBytes) - 1;
+    }
+
+    /*
+     * Non-temporal stores bypass the cache hierarchy, which avoids the costly read-for-ownership on write-combined memory.
+     * The destination must be aligned to the vector size.
+     */
+    template <bool isNonTemporal, typename Vector>
+    FORCE_INLINE static constexpr auto StoreVector(Vector *dst, const Vector &vec) -> void {
+        if constexpr (isNonTemporal && std::is_same_v<Vector, __m128i>) {
+            _mm_stream_si128(dst, vec);
+        } else if constexpr (isNonTemporal && std::is_same_v<Vector, __m256i>) {
+            _mm256_stream_si256(dst, vec);
+        } else if constexpr (isNonTemporal && std::is_same_v<Vector, __m512i>) {
+            _mm512_stream_si512(dst, vec);
+        } else {
+            *dst = vec;
+        }
+    }
 
     /*
-     * intrinsicType: 1 = SSE4, 2 = AVX2. Anything else: non-SIMD
+     * intrinsicType: 1 = SSE4, 2 = AVX2, 3 = AVX-512 (BW + VBMI). Anything else: portable, which uses Simd for two-component sources and goes per pixel otherwise
      * componentSize is the size per pixel component (1 for 8-bit, 2 for 10 and 16-bit)
      * srcNumComponents is the number of components per pixel for the source
      * dstNumComponents is the number of components per pixel for the destination
      * srcNumComponents should always >= dstNumComponents. They differ in case we want to discard certain components (e.g. the alpha plane of Y410/Y416)
      * colorFamily: 1 = YUV, 2 = RGB
+     * rightShiftSize: if non-zero, each 16-bit output component is right shifted in the same pass (e.g. for P010's MSB-aligned samples)
      */
-    template <int intrinsicType, int componentSize, int srcNumComponents, int dstNumComponents, int colorFamily>
+    template <int intrinsicType, int componentSize, int srcNumComponents, int dstNumComponents, int colorFamily, int rightShiftSize = 0>
     static constexpr auto Deinterleave(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
         /*
          * Place bytes from each plane in sequence by shuffling, then write the sequence of bytes to respective buffer.
@@ -159,14 +403,18 @@ private:
          * For AVX2, because its 256-bit shuffle instruction does not operate cross the 128-bit lane,
          * we first prepare the two 128-bit integers just like the SSSE3 version, then permute to correct the order.
          * Much like 0, 2, 1, 3 -> 0, 1, 2, 3.
+         *
+         * For AVX-512, VPERMB and VPERMW permute across the whole 512-bit register, so one instruction is enough.
+         * The row tail is processed with masked load and store instead of relying on the stride padding.
          */
 
-        Environment::GetInstance().Log(L"Deinterleave() start");
+        static_assert(rightShiftSize == 0 || componentSize == 2, "Only 16-bit components can be shifted");
 
         // Input is the type for the input data each SIMD intrustion works on (__m128i, __m256i, etc.)
         using Input = std::conditional_t<intrinsicType == 1, __m128i
                     , std::conditional_t<intrinsicType == 2, __m256i
-                    , std::array<BYTE, componentSize * srcNumComponents>>>;
+                    , std::conditional_t<intrinsicType == 3, __m512i
+                    , std::array<BYTE, componentSize * srcNumComponents>>>>;
         // Output is the type for the output of the SIMD instructions, half the size of Input
         using Output = std::array<BYTE, sizeof(Input) / srcNumComponents>;
 
@@ -197,9 +445,77 @@ private:
             } else if constexpr (srcNumComponents == 4) {
                 shuffleMask = _Y416_SHUFFLE_MASK_M256;
             }
+        } else if constexpr (intrinsicType == 3) {
+            if constexpr (componentSize == 1) {
+                if constexpr (colorFamily == 1) {
+                    shuffleMask = _UV_PERMUTE_INDEX_M512_C1;
+                } else if constexpr (colorFamily == 2) {
+                    shuffleMask = _RGB_PERMUTE_INDEX_M512_C1;
+                }
+            } else if constexpr (srcNumComponents == 2) {
+                shuffleMask = _UV_PERMUTE_INDEX_M512_C2;
+            } else if constexpr (srcNumComponents == 4) {
+                shuffleMask = _Y416_PERMUTE_INDEX_M512;
+            }
         }
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Input));
+        const auto Shuffle = [&shuffleMask](const Input &srcVec) -> Input {
+            if constexpr (intrinsicType == 1) {
+                const Input dataVec = _mm_shuffle_epi8(srcVec, shuffleMask);
+
+                if constexpr (rightShiftSize > 0) {
+                    return _mm_srli_epi16(dataVec, rightShiftSize);
+                } else {
+                    return dataVec;
+                }
+            } else if constexpr (intrinsicType == 2) {
+                const Input srcShuffle = _mm256_shuffle_epi8(srcVec, shuffleMask);
+
+                Input dataVec;
+                if constexpr (srcNumComponents == 2) {
+                    dataVec = _mm256_permute4x64_epi64(srcShuffle, _UV_PERMUTE_INDEX);
+                } else if constexpr (srcNumComponents == 4) {
+                    dataVec = _mm256_permutevar8x32_epi32(srcShuffle, _FOUR_PERMUTE_INDEX);
+                }
+
+                if constexpr (rightShiftSize > 0) {
+                    return _mm256_srli_epi16(dataVec, rightShiftSize);
+                } else {
+                    return dataVec;
+                }
+            } else if constexpr (intrinsicType == 3) {
+                Input dataVec;
+                if constexpr (componentSize == 1) {
+                    dataVec = _mm512_permutexvar_epi8(shuffleMask, srcVec);
+                } else {
+                    dataVec = _mm512_permutexvar_epi16(shuffleMask, srcVec);
+                }
+
+                if constexpr (rightShiftSize > 0) {
+                    return _mm512_srli_epi16(dataVec, rightShiftSize);
+                } else {
+                    return dataVec;
+                }
+            } else {
+                Input dataVec = srcVec;
+
+                if constexpr (rightShiftSize > 0) {
+                    for (uint16_t &component : reinterpret_cast<std::array<uint16_t, srcNumComponents> &>(dataVec)) {
+                        component >>= rightShiftSize;
+                    }
+                }
+
+                return dataVec;
+            }
+        };
+
+        // the portable kernel converts whole pairs of Simd vectors first, leaving the remainder to the per pixel loop
+        constexpr bool isPortableVector = intrinsicType == 0 && srcNumComponents == 2;
+        const int portableCycles = isPortableVector ? rowSize / (Simd::VECTOR_SIZE * 2) : 0;
+
+        // AVX-512 only processes whole vectors in the main loop, leaving the remainder to the masked tail
+        const int cycles = intrinsicType == 3 ? rowSize / static_cast<int>(sizeof(Input)) : DivideRoundUp(rowSize - portableCycles * Simd::VECTOR_SIZE * 2, sizeof(Input));
+        const int tailSize = intrinsicType == 3 ? rowSize % static_cast<int>(sizeof(Input)) : 0;
 
         for (int y = 0; y < height; ++y) {
             const Input *srcLine = reinterpret_cast<const Input *>(src);
@@ -208,79 +524,163 @@ private:
                 dstsLine[p] = reinterpret_cast<Output *>(dsts[p]);
             }
 
-            for (int i = 0; i < cycles; ++i) {
-                const Input srcVec = *srcLine++;
-                Input dataVec;
+            if constexpr (isPortableVector) {
+                for (int i = 0; i < portableCycles; ++i) {
+                    std::array<Simd::Vector, 2> dataVecs;
+                    Simd::Unzip<componentSize>(Simd::Load(srcLine), Simd::Load(reinterpret_cast<const BYTE *>(srcLine) + Simd::VECTOR_SIZE), dataVecs[0], dataVecs[1]);
+                    srcLine += Simd::VECTOR_SIZE * 2 / sizeof(Input);
 
-                if constexpr (intrinsicType == 1) {
-                    dataVec = _mm_shuffle_epi8(srcVec, shuffleMask);
-                } else if constexpr (intrinsicType == 2) {
-                    const Input srcShuffle = _mm256_shuffle_epi8(srcVec, shuffleMask);
+                    for (int p = 0; p < dstNumComponents; ++p) {
+                        if constexpr (rightShiftSize > 0) {
+                            dataVecs[p] = Simd::ShiftRight16<rightShiftSize>(dataVecs[p]);
+                        }
 
-                    if constexpr (srcNumComponents == 2) {
-                        dataVec = _mm256_permute4x64_epi64(srcShuffle, _UV_PERMUTE_INDEX);
-                    } else if constexpr (srcNumComponents == 4) {
-                        dataVec = _mm256_permutevar8x32_epi32(srcShuffle, _FOUR_PERMUTE_INDEX);
+                        Simd::Store(dstsLine[p], dataVecs[p]);
+                        dstsLine[p] += Simd::VECTOR_SIZE / sizeof(Output);
                     }
-                } else {
-                    dataVec = srcVec;
                 }
+            }
+
+            for (int i = 0; i < cycles; ++i) {
+                const Input dataVec = Shuffle(*srcLine++);
 
                 for (int p = 0; p < dstNumComponents; ++p) {
                     *dstsLine[p]++ = *(reinterpret_cast<const Output *>(&dataVec) + p);
                 }
             }
 
+            if constexpr (intrinsicType == 3) {
+                if (tailSize > 0) {
+                    const Input dataVec = Shuffle(_mm512_maskz_loadu_epi8(TailMaskM512(tailSize), srcLine));
+                    const __mmask64 dstTailMask = TailMaskM512(tailSize / srcNumComponents);
+
+                    for (int p = 0; p < dstNumComponents; ++p) {
+                        // move the output of the p-th component to the lowest lanes before the masked store
+                        const __m512i qwordIndex = _mm512_add_epi64(_QWORD_INDEX_M512, _mm512_set1_epi64(p * sizeof(Output) / sizeof(int64_t)));
+                        _mm512_mask_storeu_epi8(dstsLine[p], dstTailMask, _mm512_permutexvar_epi64(qwordIndex, dataVec));
+                    }
+                }
+            }
+
             src += srcStride;
             for (int p = 0; p < dstNumComponents; ++p) {
                 dsts[p] += dstStrides[p];
             }
         }
-
-        Environment::GetInstance().Log(L"Deinterleave() end");
     }
 
-    template <int intrinsicType, int componentSize>
+    /*
+     * leftShiftSize: if non-zero, each 16-bit component is left shifted in the same pass (e.g. for P010's MSB-aligned samples)
+     * isNonTemporal: write the destination with streaming stores, for write-combined destination buffers
+     */
+    template <int intrinsicType, int componentSize, int leftShiftSize = 0, bool isNonTemporal = false>
     static constexpr auto InterleaveUV(const BYTE *src1, const BYTE *src2, int srcStride1, int srcStride2, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-        Environment::GetInstance().Log(L"InterleaveUV() start");
+        static_assert(leftShiftSize == 0 || componentSize == 2, "Only 16-bit components can be shifted");
 
         using Vector = std::conditional_t<intrinsicType == 1, __m128i
                      , std::conditional_t<intrinsicType == 2, __m256i
-                     , std::array<BYTE, componentSize>>>;
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , std::array<BYTE, componentSize>>>>;
+
+        const auto Interleave = [](Vector src1Vec, Vector src2Vec, Vector &dstVecLo, Vector &dstVecHi) -> void {
+            if constexpr (leftShiftSize > 0) {
+                if constexpr (intrinsicType == 1) {
+                    src1Vec = _mm_slli_epi16(src1Vec, leftShiftSize);
+                    src2Vec = _mm_slli_epi16(src2Vec, leftShiftSize);
+                } else if constexpr (intrinsicType == 2) {
+                    src1Vec = _mm256_slli_epi16(src1Vec, leftShiftSize);
+                    src2Vec = _mm256_slli_epi16(src2Vec, leftShiftSize);
+                } else if constexpr (intrinsicType == 3) {
+                    src1Vec = _mm512_slli_epi16(src1Vec, leftShiftSize);
+                    src2Vec = _mm512_slli_epi16(src2Vec, leftShiftSize);
+                } else {
+                    reinterpret_cast<uint16_t &>(src1Vec) <<= leftShiftSize;
+                    reinterpret_cast<uint16_t &>(src2Vec) <<= leftShiftSize;
+                }
+            }
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Vector) * 2);
+            if constexpr (intrinsicType == 1) {
+                if constexpr (componentSize == 1) {
+                    dstVecLo = _mm_unpacklo_epi8(src1Vec, src2Vec);
+                    dstVecHi = _mm_unpackhi_epi8(src1Vec, src2Vec);
+                } else if constexpr (componentSize == 2) {
+                    dstVecLo = _mm_unpacklo_epi16(src1Vec, src2Vec);
+                    dstVecHi = _mm_unpackhi_epi16(src1Vec, src2Vec);
+                }
+            } else if constexpr (intrinsicType == 2) {
+                const Vector src1Permute = _mm256_permute4x64_epi64(src1Vec, _UV_PERMUTE_INDEX);
+                const Vector src2Permute = _mm256_permute4x64_epi64(src2Vec, _UV_PERMUTE_INDEX);
+
+                if constexpr (componentSize == 1) {
+                    dstVecLo = _mm256_unpacklo_epi8(src1Permute, src2Permute);
+                    dstVecHi = _mm256_unpackhi_epi8(src1Permute, src2Permute);
+                } else if constexpr (componentSize == 2) {
+                    dstVecLo = _mm256_unpacklo_epi16(src1Permute, src2Permute);
+                    dstVecHi = _mm256_unpackhi_epi16(src1Permute, src2Permute);
+                }
+            } else if constexpr (intrinsicType == 3) {
+                if constexpr (componentSize == 1) {
+                    dstVecLo = _mm512_permutex2var_epi8(src1Vec, _UV_INTERLEAVE_INDEX_M512_C1_LO, src2Vec);
+                    dstVecHi = _mm512_permutex2var_epi8(src1Vec, _UV_INTERLEAVE_INDEX_M512_C1_HI, src2Vec);
+                } else if constexpr (componentSize == 2) {
+                    dstVecLo = _mm512_permutex2var_epi16(src1Vec, _UV_INTERLEAVE_INDEX_M512_C2_LO, src2Vec);
+                    dstVecHi = _mm512_permutex2var_epi16(src1Vec, _UV_INTERLEAVE_INDEX_M512_C2_HI, src2Vec);
+                }
+            } else {
+                dstVecLo = src1Vec;
+                dstVecHi = src2Vec;
+            }
+        };
+
+        // the portable kernel converts whole pairs of Simd vectors first, leaving the remainder to the per component loop
+        const int portableCycles = intrinsicType == 0 ? rowSize / (Simd::VECTOR_SIZE * 2) : 0;
+
+        // AVX-512 only processes whole vectors in the main loop, leaving the remainder to the masked tail
+        const int cycles = intrinsicType == 3 ? rowSize / static_cast<int>(sizeof(Vector) * 2) : DivideRoundUp(rowSize - portableCycles * Simd::VECTOR_SIZE * 2, sizeof(Vector) * 2);
+        const int tailSize = intrinsicType == 3 ? rowSize % static_cast<int>(sizeof(Vector) * 2) : 0;
 
         for (int y = 0; y < height; ++y) {
             const Vector *src1Line = reinterpret_cast<const Vector *>(src1);
             const Vector *src2Line = reinterpret_cast<const Vector *>(src2);
             Vector *dstLine = reinterpret_cast<Vector *>(dst);
 
-            for (int i = 0; i < cycles; ++i) {
-                const Vector src1Vec = *src1Line++;
-                const Vector src2Vec = *src2Line++;
-
-                if constexpr (intrinsicType == 1) {
-                    if constexpr (componentSize == 1) {
-                        *dstLine++ = _mm_unpacklo_epi8(src1Vec, src2Vec);
-                        *dstLine++ = _mm_unpackhi_epi8(src1Vec, src2Vec);
-                    } else if constexpr (componentSize == 2) {
-                        *dstLine++ = _mm_unpacklo_epi16(src1Vec, src2Vec);
-                        *dstLine++ = _mm_unpackhi_epi16(src1Vec, src2Vec);
+            if constexpr (intrinsicType == 0) {
+                for (int i = 0; i < portableCycles; ++i) {
+                    Simd::Vector src1Vec = Simd::Load(src1Line);
+                    Simd::Vector src2Vec = Simd::Load(src2Line);
+                    if constexpr (leftShiftSize > 0) {
+                        src1Vec = Simd::ShiftLeft16<leftShiftSize>(src1Vec);
+                        src2Vec = Simd::ShiftLeft16<leftShiftSize>(src2Vec);
                     }
-                } else if constexpr (intrinsicType == 2) {
-                    const Vector src1Permute = _mm256_permute4x64_epi64(src1Vec, _UV_PERMUTE_INDEX);
-                    const Vector src2Permute = _mm256_permute4x64_epi64(src2Vec, _UV_PERMUTE_INDEX);
 
-                    if constexpr (componentSize == 1) {
-                        *dstLine++ = _mm256_unpacklo_epi8(src1Permute, src2Permute);
-                        *dstLine++ = _mm256_unpackhi_epi8(src1Permute, src2Permute);
-                    } else if constexpr (componentSize == 2) {
-                        *dstLine++ = _mm256_unpacklo_epi16(src1Permute, src2Permute);
-                        *dstLine++ = _mm256_unpackhi_epi16(src1Permute, src2Permute);
-                    }
-                } else {
-                    *dstLine++ = src1Vec;
-                    *dstLine++ = src2Vec;
+                    Simd::Vector dstVecLo;
+                    Simd::Vector dstVecHi;
+                    Simd::Zip<componentSize>(src1Vec, src2Vec, dstVecLo, dstVecHi);
+                    Simd::Store(dstLine, dstVecLo);
+                    Simd::Store(reinterpret_cast<BYTE *>(dstLine) + Simd::VECTOR_SIZE, dstVecHi);
+
+                    src1Line += Simd::VECTOR_SIZE / sizeof(Vector);
+                    src2Line += Simd::VECTOR_SIZE / sizeof(Vector);
+                    dstLine += Simd::VECTOR_SIZE * 2 / sizeof(Vector);
+                }
+            }
+
+            for (int i = 0; i < cycles; ++i) {
+                Vector dstVecLo;
+                Vector dstVecHi;
+                Interleave(*src1Line++, *src2Line++, dstVecLo, dstVecHi);
+                StoreVector<isNonTemporal>(dstLine++, dstVecLo);
+                StoreVector<isNonTemporal>(dstLine++, dstVecHi);
+            }
+
+            if constexpr (intrinsicType == 3) {
+                if (tailSize > 0) {
+                    const __mmask64 srcTailMask = TailMaskM512(tailSize / 2);
+                    Vector dstVecLo;
+                    Vector dstVecHi;
+                    Interleave(_mm512_maskz_loadu_epi8(srcTailMask, src1Line), _mm512_maskz_loadu_epi8(srcTailMask, src2Line), dstVecLo, dstVecHi);
+                    _mm512_mask_storeu_epi8(dstLine, TailMaskM512(tailSize), dstVecLo);
+                    _mm512_mask_storeu_epi8(dstLine + 1, TailMaskM512(tailSize - static_cast<int>(sizeof(Vector))), dstVecHi);
                 }
             }
 
@@ -289,27 +689,46 @@ private:
             dst += dstStride;
         }
 
-        Environment::GetInstance().Log(L"InterleaveUV() end");
+        if constexpr (isNonTemporal) {
+            _mm_sfence();
+        }
     }
 
-    template <int colorFamily>
+    template <int intrinsicType, int colorFamily>
     static constexpr auto InterleaveThree(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-        // Extract 32-bit integers from each sources and form 128-bit integer, then shuffle to the correct order
-
-        Environment::GetInstance().Log(L"InterleaveThree() start");
+        /*
+         * scalar: write each pixel's components from the sources, with the fourth component at maximum
+         * SSE4: extract 32-bit integers from each sources and form 128-bit integer, then shuffle to the correct order
+         * AVX2: unpack 128-bit vectors of all sources into two 256-bit vectors, each lane holding the same layout as the SSE4 vector,
+         *       shuffle them in lane, then permute the lanes back to pixel order
+         */
 
-        using Input = uint32_t;
-        using Output = __m128i;
+        using Input = std::conditional_t<intrinsicType <= 1, uint32_t, __m128i>;
+        using Output = std::conditional_t<intrinsicType <= 1, __m128i, __m256i>;
 
         Output shuffleMask;
-        if constexpr (colorFamily == 1) {
-            shuffleMask = _UV_SHUFFLE_MASK_M128_C2;
-        } else if constexpr (colorFamily == 2) {
-            shuffleMask = _RGB_SHUFFLE_MASK_M128_C1;
+        if constexpr (intrinsicType == 1) {
+            if constexpr (colorFamily == 1) {
+                shuffleMask = _UV_SHUFFLE_MASK_M128_C2;
+            } else if constexpr (colorFamily == 2) {
+                shuffleMask = _RGB_SHUFFLE_MASK_M128_C1;
+            }
+        } else if constexpr (intrinsicType == 2) {
+            // both lanes use the same mask as SSE4
+            if constexpr (colorFamily == 1) {
+                shuffleMask = _mm256_broadcastsi128_si256(_UV_SHUFFLE_MASK_M128_C2);
+            } else if constexpr (colorFamily == 2) {
+                shuffleMask = _mm256_broadcastsi128_si256(_RGB_SHUFFLE_MASK_M128_C1);
+            }
         }
-        const Output initial = _mm_set1_epi8(-1);
+        const __m128i initial = _mm_set1_epi8(-1);
+
+        using Component = std::conditional_t<colorFamily == 1, uint16_t, uint8_t>;
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Output));
+        // each AVX2 cycle writes two output vectors
+        // the scalar path writes exactly the pixels of the row, since its output stride alignment is smaller than a vector
+        const int cycles = intrinsicType == 0 ? 0 : DivideRoundUp(rowSize, sizeof(Output) * (intrinsicType == 1 ? 1 : 2));
+        const int scalarPixels = intrinsicType == 0 ? rowSize / static_cast<int>(sizeof(Component) * 4) : 0;
 
         for (int y = 0; y < height; ++y) {
             std::array<const Input *, srcs.size()> srcsLine;
@@ -319,10 +738,35 @@ private:
             Output *dstLine = reinterpret_cast<Output *>(dst);
 
             for (int i = 0; i < cycles; ++i) {
-                Output vec = _mm_insert_epi32(initial, *srcsLine[0]++, 0);
-                vec = _mm_insert_epi32(vec, *srcsLine[1]++, 1);
-                vec = _mm_insert_epi32(vec, *srcsLine[2]++, 2);
-                *dstLine++ = _mm_shuffle_epi8(vec, shuffleMask);
+                if constexpr (intrinsicType == 1) {
+                    Output vec = _mm_insert_epi32(initial, *srcsLine[0]++, 0);
+                    vec = _mm_insert_epi32(vec, *srcsLine[1]++, 1);
+                    vec = _mm_insert_epi32(vec, *srcsLine[2]++, 2);
+                    *dstLine++ = _mm_shuffle_epi8(vec, shuffleMask);
+                } else if constexpr (intrinsicType == 2) {
+                    const Input src0Vec = _mm_loadu_si128(srcsLine[0]++);
+                    const Input src1Vec = _mm_loadu_si128(srcsLine[1]++);
+                    const Input src2Vec = _mm_loadu_si128(srcsLine[2]++);
+
+                    // lane 0 holds 32-bit integers 0 and 1 of each source, lane 1 holds 2 and 3
+                    const Output src01Vec = _mm256_set_m128i(_mm_unpackhi_epi32(src0Vec, src1Vec), _mm_unpacklo_epi32(src0Vec, src1Vec));
+                    const Output src2InitialVec = _mm256_set_m128i(_mm_unpackhi_epi32(src2Vec, initial), _mm_unpacklo_epi32(src2Vec, initial));
+
+                    // dstVec1 has output vectors 0 and 2 of SSE4, dstVec2 has 1 and 3
+                    const Output dstVec1 = _mm256_shuffle_epi8(_mm256_unpacklo_epi64(src01Vec, src2InitialVec), shuffleMask);
+                    const Output dstVec2 = _mm256_shuffle_epi8(_mm256_unpackhi_epi64(src01Vec, src2InitialVec), shuffleMask);
+
+                    *dstLine++ = _mm256_permute2x128_si256(dstVec1, dstVec2, 0x20);
+                    *dstLine++ = _mm256_permute2x128_si256(dstVec1, dstVec2, 0x31);
+                }
+            }
+
+            Component *dstComponents = reinterpret_cast<Component *>(dst);
+            for (int i = 0; i < scalarPixels; ++i) {
+                for (size_t p = 0; p < srcs.size(); ++p) {
+                    *dstComponents++ = reinterpret_cast<const Component *>(srcs[p])[i];
+                }
+                *dstComponents++ = static_cast<Component>(-1);
             }
 
             for (size_t p = 0; p < srcs.size(); ++p) {
@@ -330,68 +774,1598 @@ private:
             }
             dst += dstStride;
         }
-
-        Environment::GetInstance().Log(L"InterleaveThree() end");
     }
 
-    template <int intrinsicType, int shiftSize, bool isRightShift>
-    static constexpr auto BitShiftEach16BitInt(BYTE *src, BYTE *dst, int stride, int rowSize, int height) -> void {
-        Environment::GetInstance().Log(L"BitShiftEach16BitInt(%d) start", isRightShift);
-
+    /*
+     * Shift each 16-bit integer while copying from src to dst. src and dst could be the same buffer.
+     * isNonTemporal: write the destination with streaming stores, for write-combined destination buffers
+     */
+    template <int intrinsicType, int shiftSize, bool isRightShift, bool isNonTemporal = false>
+    static constexpr auto BitShiftEach16BitInt(const BYTE *src, int srcStride, BYTE *dst, int dstStride, int rowSize, int height) -> void {
         using Vector = std::conditional_t<intrinsicType == 1, __m128i
                      , std::conditional_t<intrinsicType == 2, __m256i
-                     , uint16_t>>;
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , uint16_t>>>;
 
-        const int cycles = DivideRoundUp(rowSize, sizeof(Vector));
+        const auto Shift = [](const Vector &srcVec) -> Vector {
+            if constexpr (intrinsicType == 1) {
+                if constexpr (isRightShift) {
+                    return _mm_srli_epi16(srcVec, shiftSize);
+                } else {
+                    return _mm_slli_epi16(srcVec, shiftSize);
+                }
+            } else if constexpr (intrinsicType == 2) {
+                if constexpr (isRightShift) {
+                    return _mm256_srli_epi16(srcVec, shiftSize);
+                } else {
+                    return _mm256_slli_epi16(srcVec, shiftSize);
+                }
+            } else if constexpr (intrinsicType == 3) {
+                if constexpr (isRightShift) {
+                    return _mm512_srli_epi16(srcVec, shiftSize);
+                } else {
+                    return _mm512_slli_epi16(srcVec, shiftSize);
+                }
+            } else {
+                if constexpr (isRightShift) {
+                    return srcVec >> shiftSize;
+                } else {
+                    return srcVec << shiftSize;
+                }
+            }
+        };
+
+        // AVX-512 only processes whole vectors in the main loop, leaving the remainder to the masked tail
+        const int cycles = intrinsicType == 3 ? rowSize / static_cast<int>(sizeof(Vector)) : DivideRoundUp(rowSize, sizeof(Vector));
+        const int tailSize = intrinsicType == 3 ? rowSize % static_cast<int>(sizeof(Vector)) : 0;
 
         for (int y = 0; y < height; ++y) {
-            Vector *srcLine = reinterpret_cast<Vector *>(src);
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
             Vector *dstLine = reinterpret_cast<Vector *>(dst);
 
             for (int i = 0; i < cycles; ++i) {
+                StoreVector<isNonTemporal>(dstLine++, Shift(*srcLine++));
+            }
+
+            if constexpr (intrinsicType == 3) {
+                if (tailSize > 0) {
+                    const __mmask64 tailMask = TailMaskM512(tailSize);
+                    _mm512_mask_storeu_epi8(dstLine, tailMask, Shift(_mm512_maskz_loadu_epi8(tailMask, srcLine)));
+                }
+            }
+
+            src += srcStride;
+            dst += dstStride;
+        }
+
+        if constexpr (isNonTemporal) {
+            _mm_sfence();
+        }
+    }
+
+    /*
+     * Reduce the bit depth of 16-bit components to the 8-bit or the MSB-aligned 10-bit output, such as from YUV420P16 to NV12 or P010.
+     * The source samples are first aligned to the most significant bits, so that all source bit depths share the same math.
+     * Then the ordered dither is added with saturation before the least significant bits are dropped.
+     * firstRow is the row number of src in the frame, which selects the row of the dither matrix.
+     */
+    template <int intrinsicType, int dstBitsPerComponent>
+    FORCE_INLINE static constexpr auto ReduceDither(const auto &srcVec, const auto &alignShift, const auto &ditherVec) {
+        if constexpr (intrinsicType == 1) {
+            const __m128i dataVec = _mm_adds_epu16(_mm_sll_epi16(srcVec, alignShift), ditherVec);
+
+            if constexpr (dstBitsPerComponent == 8) {
+                return _mm_srli_epi16(dataVec, 8);
+            } else {
+                return _mm_and_si128(dataVec, _mm_set1_epi16(static_cast<int16_t>(0xffc0)));
+            }
+        } else if constexpr (intrinsicType == 2) {
+            const __m256i dataVec = _mm256_adds_epu16(_mm256_sll_epi16(srcVec, alignShift), ditherVec);
+
+            if constexpr (dstBitsPerComponent == 8) {
+                return _mm256_srli_epi16(dataVec, 8);
+            } else {
+                return _mm256_and_si256(dataVec, _mm256_set1_epi16(static_cast<int16_t>(0xffc0)));
+            }
+        } else {
+            const int dataVal = std::min((srcVec << alignShift) + ditherVec, UINT16_MAX);
+
+            if constexpr (dstBitsPerComponent == 8) {
+                return static_cast<uint8_t>(dataVal >> 8);
+            } else {
+                return static_cast<uint16_t>(dataVal & 0xffc0);
+            }
+        }
+    }
+
+    /*
+     * Dither offsets of one row of the matrix, scaled to the bits dropped from the MSB-aligned 16-bit samples.
+     * Each 64-bit integer holds the 4 offsets in 16-bit lanes, to be broadcast to the whole vector.
+     */
+    template <int dstBitsPerComponent>
+    static constexpr auto GenerateDitherRows() -> std::array<int64_t, 4> {
+        std::array<int64_t, 4> ret {};
+
+        for (size_t r = 0; r < ret.size(); ++r) {
+            for (size_t c = 0; c < _BAYER_MATRIX[r].size(); ++c) {
+                ret[r] |= static_cast<int64_t>(_BAYER_MATRIX[r][c] << (12 - dstBitsPerComponent)) << (c * 16);
+            }
+        }
+
+        return ret;
+    }
+
+    /*
+     * width is the number of samples in each row of src.
+     */
+    template <int intrinsicType, int dstBitsPerComponent>
+    static constexpr auto ReduceBitDepth(const BYTE *src, int srcStride, BYTE *dst, int dstStride, int width, int height, int srcBitsPerComponent, int firstRow) -> void {
+        static_assert(dstBitsPerComponent == 8 || dstBitsPerComponent == 10, "Only 8 and 10-bit outputs are supported");
+
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<dstBitsPerComponent == 8, uint8_t, uint16_t>;
+
+        constexpr std::array<int64_t, 4> ditherRows = GenerateDitherRows<dstBitsPerComponent>();
+        const int alignShiftSize = 16 - srcBitsPerComponent;
+        const __m128i alignShift = _mm_cvtsi32_si128(alignShiftSize);
+
+        // each cycle reduces two vectors of source
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? DivideRoundUp(width, sizeof(Vector)) : 0;
+        const int tailWidth = intrinsicType == 1 || intrinsicType == 2 ? 0 : width;
+
+        for (int y = 0; y < height; ++y) {
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+            Vector *dstLine = reinterpret_cast<Vector *>(dst);
+            const int ditherRow = (firstRow + y) % _BAYER_MATRIX.size();
+
+            if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+                Vector ditherVec;
                 if constexpr (intrinsicType == 1) {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = _mm_srli_epi16(*srcLine++, shiftSize);
-                    } else {
-                        *dstLine++ = _mm_slli_epi16(*srcLine++, shiftSize);
-                    }
-                } else if constexpr (intrinsicType == 2) {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = _mm256_srli_epi16(*srcLine++, shiftSize);
+                    ditherVec = _mm_set1_epi64x(ditherRows[ditherRow]);
+                } else {
+                    ditherVec = _mm256_set1_epi64x(ditherRows[ditherRow]);
+                }
+
+                for (int i = 0; i < cycles; ++i) {
+                    const Vector dataVec1 = ReduceDither<intrinsicType, dstBitsPerComponent>(*srcLine++, alignShift, ditherVec);
+                    const Vector dataVec2 = ReduceDither<intrinsicType, dstBitsPerComponent>(*srcLine++, alignShift, ditherVec);
+
+                    if constexpr (dstBitsPerComponent == 10) {
+                        *dstLine++ = dataVec1;
+                        *dstLine++ = dataVec2;
+                    } else if constexpr (intrinsicType == 1) {
+                        *dstLine++ = _mm_packus_epi16(dataVec1, dataVec2);
                     } else {
-                        *dstLine++ = _mm256_slli_epi16(*srcLine++, shiftSize);
+                        // PACKUSWB works within each lane
+                        *dstLine++ = _mm256_permute4x64_epi64(_mm256_packus_epi16(dataVec1, dataVec2), _UV_PERMUTE_INDEX);
                     }
+                }
+            }
+
+            const uint16_t *srcTail = reinterpret_cast<const uint16_t *>(srcLine);
+            Component *dstTail = reinterpret_cast<Component *>(dstLine);
+            for (int x = 0; x < tailWidth; ++x) {
+                *dstTail++ = ReduceDither<0, dstBitsPerComponent>(static_cast<int>(*srcTail++), alignShiftSize, _BAYER_MATRIX[ditherRow][x % 4] << (12 - dstBitsPerComponent));
+            }
+
+            src += srcStride;
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * InterleaveUV() with the bit depth reduced in the same pass. width is the number of samples in each row of src1 and src2.
+     */
+    template <int intrinsicType, int dstBitsPerComponent>
+    static constexpr auto InterleaveUVReduceBitDepth(const BYTE *src1, const BYTE *src2, int srcStride1, int srcStride2, BYTE *dst, int dstStride, int width, int height, int srcBitsPerComponent, int firstRow) -> void {
+        static_assert(dstBitsPerComponent == 8 || dstBitsPerComponent == 10, "Only 8 and 10-bit outputs are supported");
+
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<dstBitsPerComponent == 8, uint8_t, uint16_t>;
+
+        constexpr std::array<int64_t, 4> ditherRows = GenerateDitherRows<dstBitsPerComponent>();
+        const int alignShiftSize = 16 - srcBitsPerComponent;
+        const __m128i alignShift = _mm_cvtsi32_si128(alignShiftSize);
+
+        // each cycle reduces one vector of each source
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? DivideRoundUp(width, sizeof(Vector) / 2) : 0;
+        const int tailWidth = intrinsicType == 1 || intrinsicType == 2 ? 0 : width;
+
+        for (int y = 0; y < height; ++y) {
+            const Vector *src1Line = reinterpret_cast<const Vector *>(src1);
+            const Vector *src2Line = reinterpret_cast<const Vector *>(src2);
+            Vector *dstLine = reinterpret_cast<Vector *>(dst);
+            const int ditherRow = (firstRow + y) % _BAYER_MATRIX.size();
+
+            if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+                Vector ditherVec;
+                if constexpr (intrinsicType == 1) {
+                    ditherVec = _mm_set1_epi64x(ditherRows[ditherRow]);
                 } else {
-                    if constexpr (isRightShift) {
-                        *dstLine++ = *srcLine++ >> shiftSize;
+                    ditherVec = _mm256_set1_epi64x(ditherRows[ditherRow]);
+                }
+
+                for (int i = 0; i < cycles; ++i) {
+                    const Vector src1Vec = ReduceDither<intrinsicType, dstBitsPerComponent>(*src1Line++, alignShift, ditherVec);
+                    const Vector src2Vec = ReduceDither<intrinsicType, dstBitsPerComponent>(*src2Line++, alignShift, ditherVec);
+
+                    if constexpr (intrinsicType == 1) {
+                        if constexpr (dstBitsPerComponent == 8) {
+                            *dstLine++ = _mm_shuffle_epi8(_mm_packus_epi16(src1Vec, src2Vec), _UV_INTERLEAVE_MASK_C1);
+                        } else {
+                            *dstLine++ = _mm_unpacklo_epi16(src1Vec, src2Vec);
+                            *dstLine++ = _mm_unpackhi_epi16(src1Vec, src2Vec);
+                        }
                     } else {
-                        *dstLine++ = *srcLine++ << shiftSize;
+                        if constexpr (dstBitsPerComponent == 8) {
+                            // PACKUSWB places the samples of both sources in each lane, so the shuffle does not cross lanes
+                            *dstLine++ = _mm256_shuffle_epi8(_mm256_packus_epi16(src1Vec, src2Vec), _mm256_broadcastsi128_si256(_UV_INTERLEAVE_MASK_C1));
+                        } else {
+                            const __m256i dstVecLo = _mm256_unpacklo_epi16(src1Vec, src2Vec);
+                            const __m256i dstVecHi = _mm256_unpackhi_epi16(src1Vec, src2Vec);
+                            *dstLine++ = _mm256_permute2x128_si256(dstVecLo, dstVecHi, 0x20);
+                            *dstLine++ = _mm256_permute2x128_si256(dstVecLo, dstVecHi, 0x31);
+                        }
                     }
                 }
             }
 
-            src += stride;
-            dst += stride;
-        }
+            const uint16_t *src1Tail = reinterpret_cast<const uint16_t *>(src1Line);
+            const uint16_t *src2Tail = reinterpret_cast<const uint16_t *>(src2Line);
+            Component *dstTail = reinterpret_cast<Component *>(dstLine);
+            for (int x = 0; x < tailWidth; ++x) {
+                const int dither = _BAYER_MATRIX[ditherRow][x % 4] << (12 - dstBitsPerComponent);
+                *dstTail++ = ReduceDither<0, dstBitsPerComponent>(static_cast<int>(*src1Tail++), alignShiftSize, dither);
+                *dstTail++ = ReduceDither<0, dstBitsPerComponent>(static_cast<int>(*src2Tail++), alignShiftSize, dither);
+            }
 
-        Environment::GetInstance().Log(L"BitShiftEach16BitInt(%d) end", isRightShift);
+            src1 += srcStride1;
+            src2 += srcStride2;
+            dst += dstStride;
+        }
     }
 
-    static auto DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void;
-    static auto InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void;
+    /*
+     * Convert 8-bit planar YUV to RGB32 in B-G-R-A order with opaque alpha. Chroma of the subsampled columns and rows is replicated.
+     * srcs point to the first row of each plane in the frame, and firstRow is the luma row that dst starts from,
+     * so that the stripes do not need to start at the subsampled rows.
+     * Each SSE4 cycle converts 8 pixels, each AVX2 cycle converts 16.
+     */
+    template <int intrinsicType, int subsampleWidthRatio>
+    static constexpr auto ConvertYUVToRGB32(const std::array<const BYTE *, 3> &srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int width, int height, int firstRow, int subsampleHeightRatio, const YUVToRGBCoefficients &coeffs) -> void {
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        constexpr int PIXELS_PER_CYCLE = sizeof(Vector) / 2;
+
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? DivideRoundUp(width, PIXELS_PER_CYCLE) : 0;
+        const int tailWidth = intrinsicType == 1 || intrinsicType == 2 ? 0 : width;
+
+        Vector lumaOffsetVec;
+        Vector chromaOffsetVec;
+        Vector lumaVec;
+        Vector crToRVec;
+        Vector cbToGVec;
+        Vector crToGVec;
+        Vector cbToBVec;
+        Vector roundingVec;
+        Vector alphaVec;
+        Vector interleaveMask;
+        if constexpr (intrinsicType == 1) {
+            lumaOffsetVec = _mm_set1_epi16(coeffs.lumaOffset);
+            chromaOffsetVec = _mm_set1_epi16(128);
+            lumaVec = _mm_set1_epi16(coeffs.luma);
+            crToRVec = _mm_set1_epi16(coeffs.crToR);
+            cbToGVec = _mm_set1_epi16(coeffs.cbToG);
+            crToGVec = _mm_set1_epi16(coeffs.crToG);
+            cbToBVec = _mm_set1_epi16(coeffs.cbToB);
+            roundingVec = _mm_set1_epi16(8);
+            alphaVec = _mm_set1_epi16(UINT8_MAX);
+            interleaveMask = _UV_INTERLEAVE_MASK_C1;
+        } else if constexpr (intrinsicType == 2) {
+            lumaOffsetVec = _mm256_set1_epi16(coeffs.lumaOffset);
+            chromaOffsetVec = _mm256_set1_epi16(128);
+            lumaVec = _mm256_set1_epi16(coeffs.luma);
+            crToRVec = _mm256_set1_epi16(coeffs.crToR);
+            cbToGVec = _mm256_set1_epi16(coeffs.cbToG);
+            crToGVec = _mm256_set1_epi16(coeffs.crToG);
+            cbToBVec = _mm256_set1_epi16(coeffs.cbToB);
+            roundingVec = _mm256_set1_epi16(8);
+            alphaVec = _mm256_set1_epi16(UINT8_MAX);
+            interleaveMask = _mm256_broadcastsi128_si256(_UV_INTERLEAVE_MASK_C1);
+        }
 
-    static inline decltype(Deinterleave<0, 1, 2, 2, 1>) *_deinterleaveUVC1Func;
-    static inline decltype(Deinterleave<0, 2, 2, 2, 1>) *_deinterleaveUVC2Func;
-    static inline decltype(Deinterleave<0, 2, 4, 3, 1>) *_deinterleaveY416Func;
-    static inline decltype(Deinterleave<0, 1, 4, 3, 2>) *_deinterleaveRGBC1Func;
-    static inline decltype(InterleaveUV<0, 1>) *_interleaveUVC1Func;
-    static inline decltype(InterleaveUV<0, 2>) *_interleaveUVC2Func;
-    static inline decltype(InterleaveThree<1>) *_interleaveY416Func;
-    static inline decltype(InterleaveThree<2>) *_interleaveRGBC1Func;
-    static inline decltype(BitShiftEach16BitInt<0, 6, true>) *_rightShiftFunc;
-    static inline decltype(BitShiftEach16BitInt<0, 6, false>) *_leftShiftFunc;
+        const auto MulHrs = [](int sample, int coeff) -> int {
+            return (sample * coeff + (1 << 14)) >> 15;
+        };
+
+        for (int y = firstRow; y < firstRow + height; ++y) {
+            const BYTE *srcLumaLine = srcs[0] + static_cast<ptrdiff_t>(y) * srcStrides[0];
+            const BYTE *srcCbLine = srcs[1] + static_cast<ptrdiff_t>(y / subsampleHeightRatio) * srcStrides[1];
+            const BYTE *srcCrLine = srcs[2] + static_cast<ptrdiff_t>(y / subsampleHeightRatio) * srcStrides[2];
+            Vector *dstLine = reinterpret_cast<Vector *>(dst);
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 1) {
+                    const __m128i lumaBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcLumaLine));
+                    __m128i cbBytes;
+                    __m128i crBytes;
+                    if constexpr (subsampleWidthRatio == 2) {
+                        cbBytes = _mm_loadu_si32(srcCbLine);
+                        crBytes = _mm_loadu_si32(srcCrLine);
+                        cbBytes = _mm_unpacklo_epi8(cbBytes, cbBytes);
+                        crBytes = _mm_unpacklo_epi8(crBytes, crBytes);
+                    } else {
+                        cbBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcCbLine));
+                        crBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcCrLine));
+                    }
+
+                    const __m128i lumaVal = _mm_mulhrs_epi16(_mm_slli_epi16(_mm_sub_epi16(_mm_cvtepu8_epi16(lumaBytes), lumaOffsetVec), 6), lumaVec);
+                    const __m128i cbVal = _mm_slli_epi16(_mm_sub_epi16(_mm_cvtepu8_epi16(cbBytes), chromaOffsetVec), 6);
+                    const __m128i crVal = _mm_slli_epi16(_mm_sub_epi16(_mm_cvtepu8_epi16(crBytes), chromaOffsetVec), 6);
+
+                    __m128i r = _mm_add_epi16(lumaVal, _mm_mulhrs_epi16(crVal, crToRVec));
+                    __m128i g = _mm_sub_epi16(_mm_sub_epi16(lumaVal, _mm_mulhrs_epi16(cbVal, cbToGVec)), _mm_mulhrs_epi16(crVal, crToGVec));
+                    __m128i b = _mm_add_epi16(lumaVal, _mm_mulhrs_epi16(cbVal, cbToBVec));
+                    r = _mm_srai_epi16(_mm_add_epi16(r, roundingVec), 4);
+                    g = _mm_srai_epi16(_mm_add_epi16(g, roundingVec), 4);
+                    b = _mm_srai_epi16(_mm_add_epi16(b, roundingVec), 4);
+
+                    // PACKUSWB clamps to [0, 255], then the two halves are interleaved as B-G and R-A pairs
+                    const __m128i bg = _mm_shuffle_epi8(_mm_packus_epi16(b, g), interleaveMask);
+                    const __m128i ra = _mm_shuffle_epi8(_mm_packus_epi16(r, alphaVec), interleaveMask);
+
+                    *dstLine++ = _mm_unpacklo_epi16(bg, ra);
+                    *dstLine++ = _mm_unpackhi_epi16(bg, ra);
+                } else if constexpr (intrinsicType == 2) {
+                    const __m128i lumaBytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLumaLine));
+                    __m128i cbBytes;
+                    __m128i crBytes;
+                    if constexpr (subsampleWidthRatio == 2) {
+                        cbBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcCbLine));
+                        crBytes = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcCrLine));
+                        cbBytes = _mm_unpacklo_epi8(cbBytes, cbBytes);
+                        crBytes = _mm_unpacklo_epi8(crBytes, crBytes);
+                    } else {
+                        cbBytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcCbLine));
+                        crBytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcCrLine));
+                    }
+
+                    const __m256i lumaVal = _mm256_mulhrs_epi16(_mm256_slli_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(lumaBytes), lumaOffsetVec), 6), lumaVec);
+                    const __m256i cbVal = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(cbBytes), chromaOffsetVec), 6);
+                    const __m256i crVal = _mm256_slli_epi16(_mm256_sub_epi16(_mm256_cvtepu8_epi16(crBytes), chromaOffsetVec), 6);
+
+                    __m256i r = _mm256_add_epi16(lumaVal, _mm256_mulhrs_epi16(crVal, crToRVec));
+                    __m256i g = _mm256_sub_epi16(_mm256_sub_epi16(lumaVal, _mm256_mulhrs_epi16(cbVal, cbToGVec)), _mm256_mulhrs_epi16(crVal, crToGVec));
+                    __m256i b = _mm256_add_epi16(lumaVal, _mm256_mulhrs_epi16(cbVal, cbToBVec));
+                    r = _mm256_srai_epi16(_mm256_add_epi16(r, roundingVec), 4);
+                    g = _mm256_srai_epi16(_mm256_add_epi16(g, roundingVec), 4);
+                    b = _mm256_srai_epi16(_mm256_add_epi16(b, roundingVec), 4);
+
+                    // lane 0 holds pixels 0 to 7 and lane 1 holds pixels 8 to 15, each in the same layout as SSE4
+                    const __m256i bg = _mm256_shuffle_epi8(_mm256_packus_epi16(b, g), interleaveMask);
+                    const __m256i ra = _mm256_shuffle_epi8(_mm256_packus_epi16(r, alphaVec), interleaveMask);
+                    const __m256i dstVec1 = _mm256_unpacklo_epi16(bg, ra);
+                    const __m256i dstVec2 = _mm256_unpackhi_epi16(bg, ra);
+
+                    *dstLine++ = _mm256_permute2x128_si256(dstVec1, dstVec2, 0x20);
+                    *dstLine++ = _mm256_permute2x128_si256(dstVec1, dstVec2, 0x31);
+                }
+
+                srcLumaLine += PIXELS_PER_CYCLE;
+                srcCbLine += PIXELS_PER_CYCLE / subsampleWidthRatio;
+                srcCrLine += PIXELS_PER_CYCLE / subsampleWidthRatio;
+            }
+
+            // same math as the vectors, so that all intrinsic types produce identical output
+            BYTE *dstTail = reinterpret_cast<BYTE *>(dstLine);
+            for (int x = 0; x < tailWidth; ++x) {
+                const int lumaVal = MulHrs((srcLumaLine[x] - coeffs.lumaOffset) << 6, coeffs.luma);
+                const int cbVal = (srcCbLine[x / subsampleWidthRatio] - 128) << 6;
+                const int crVal = (srcCrLine[x / subsampleWidthRatio] - 128) << 6;
+
+                const std::array bgr {
+                    lumaVal + MulHrs(cbVal, coeffs.cbToB),
+                    lumaVal - MulHrs(cbVal, coeffs.cbToG) - MulHrs(crVal, coeffs.crToG),
+                    lumaVal + MulHrs(crVal, coeffs.crToR),
+                };
+                for (const int component : bgr) {
+                    *dstTail++ = static_cast<BYTE>(std::clamp((component + 8) >> 4, 0, UINT8_MAX));
+                }
+                *dstTail++ = UINT8_MAX;
+            }
+
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * Rounded average of the samples, the same as PAVGB and PAVGW.
+     */
+    template <int intrinsicType, int componentSize>
+    FORCE_INLINE static constexpr auto Average(const auto &vec1, const auto &vec2) {
+        if constexpr (intrinsicType == 1) {
+            if constexpr (componentSize == 1) {
+                return _mm_avg_epu8(vec1, vec2);
+            } else {
+                return _mm_avg_epu16(vec1, vec2);
+            }
+        } else if constexpr (intrinsicType == 2) {
+            if constexpr (componentSize == 1) {
+                return _mm256_avg_epu8(vec1, vec2);
+            } else {
+                return _mm256_avg_epu16(vec1, vec2);
+            }
+        } else {
+            return (vec1 + vec2 + 1) >> 1;
+        }
+    }
+
+    /*
+     * Vertical stage of the chroma resampling. dst is the even average of the two rows when downsampling,
+     * or weighted 3:1 towards src1 when upsampling, as the output row lies a quarter of the way from src1 to src2.
+     */
+    template <int intrinsicType, int componentSize>
+    static constexpr auto AverageRows(const BYTE *src1, const BYTE *src2, BYTE *dst, int rowSize, bool isWeighted) -> void {
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<componentSize == 1, uint8_t, uint16_t>;
+
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? DivideRoundUp(rowSize, sizeof(Vector)) : 0;
+        const int tailWidth = intrinsicType == 1 || intrinsicType == 2 ? 0 : rowSize / componentSize;
+
+        const Vector *src1Line = reinterpret_cast<const Vector *>(src1);
+        const Vector *src2Line = reinterpret_cast<const Vector *>(src2);
+        Vector *dstLine = reinterpret_cast<Vector *>(dst);
+
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            for (int i = 0; i < cycles; ++i) {
+                const Vector src1Vec = *src1Line++;
+                const Vector src2Vec = *src2Line++;
+                const Vector averageVec = Average<intrinsicType, componentSize>(src1Vec, src2Vec);
+                *dstLine++ = isWeighted ? Average<intrinsicType, componentSize>(src1Vec, averageVec) : averageVec;
+            }
+        }
+
+        const Component *src1Tail = reinterpret_cast<const Component *>(src1Line);
+        const Component *src2Tail = reinterpret_cast<const Component *>(src2Line);
+        Component *dstTail = reinterpret_cast<Component *>(dstLine);
+        for (int x = 0; x < tailWidth; ++x) {
+            const int averageVal = Average<0, componentSize>(static_cast<int>(src1Tail[x]), static_cast<int>(src2Tail[x]));
+            dstTail[x] = static_cast<Component>(isWeighted ? Average<0, componentSize>(static_cast<int>(src1Tail[x]), averageVal) : averageVal);
+        }
+    }
+
+    /*
+     * Horizontal stage of the chroma resampling, fused with InterleaveUV() for one row.
+     * The chroma samples are co-sited with the even luma columns, as in 4:2:0 and 4:2:2 of MPEG-2 and later.
+     * Downsampling applies the [1, 2, 1] filter centered at the even source samples, and upsampling interpolates the odd output samples linearly.
+     * width is the number of output samples in each plane, and srcWidth the number of samples in each row of src1 and src2.
+     * leftShiftSize aligns 16-bit components to the most significant bits after filtering, such as for P010 from 10-bit.
+     * The vectors only cover the samples whose neighbors are within the row, the edges are left to the scalar tail.
+     */
+    template <int intrinsicType, int componentSize, bool isDownsampling>
+    static constexpr auto InterleaveUVResample(const BYTE *src1, const BYTE *src2, BYTE *dst, int width, int srcWidth, int leftShiftSize) -> void {
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<componentSize == 1, uint8_t, uint16_t>;
+        constexpr int SAMPLES_PER_VECTOR = sizeof(Vector) / componentSize;
+
+        int cycles = 0;
+        if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            if constexpr (isDownsampling) {
+                // each cycle reads two vectors and writes one vector of each plane
+                cycles = std::min(width, srcWidth / 2) / SAMPLES_PER_VECTOR;
+            } else {
+                // each cycle reads one vector and the next sample, and writes two vectors of each plane
+                cycles = std::min(width / 2, srcWidth - 1) / SAMPLES_PER_VECTOR;
+            }
+        }
+
+        const __m128i leftShift = _mm_cvtsi32_si128(leftShiftSize);
+
+        const auto LeftShift = [&leftShift](Vector vec) -> Vector {
+            if constexpr (componentSize == 2) {
+                if constexpr (intrinsicType == 1) {
+                    vec = _mm_sll_epi16(vec, leftShift);
+                } else if constexpr (intrinsicType == 2) {
+                    vec = _mm256_sll_epi16(vec, leftShift);
+                }
+            }
+            return vec;
+        };
+
+        const auto Interleave = [](Vector src1Vec, Vector src2Vec, Vector *&dstLine) -> void {
+            if constexpr (intrinsicType == 1) {
+                if constexpr (componentSize == 1) {
+                    *dstLine++ = _mm_unpacklo_epi8(src1Vec, src2Vec);
+                    *dstLine++ = _mm_unpackhi_epi8(src1Vec, src2Vec);
+                } else {
+                    *dstLine++ = _mm_unpacklo_epi16(src1Vec, src2Vec);
+                    *dstLine++ = _mm_unpackhi_epi16(src1Vec, src2Vec);
+                }
+            } else if constexpr (intrinsicType == 2) {
+                const __m256i src1Permute = _mm256_permute4x64_epi64(src1Vec, _UV_PERMUTE_INDEX);
+                const __m256i src2Permute = _mm256_permute4x64_epi64(src2Vec, _UV_PERMUTE_INDEX);
+
+                if constexpr (componentSize == 1) {
+                    *dstLine++ = _mm256_unpacklo_epi8(src1Permute, src2Permute);
+                    *dstLine++ = _mm256_unpackhi_epi8(src1Permute, src2Permute);
+                } else {
+                    *dstLine++ = _mm256_unpacklo_epi16(src1Permute, src2Permute);
+                    *dstLine++ = _mm256_unpackhi_epi16(src1Permute, src2Permute);
+                }
+            }
+        };
+
+        Vector *dstLine = reinterpret_cast<Vector *>(dst);
+
+        if constexpr ((intrinsicType == 1 || intrinsicType == 2) && isDownsampling) {
+            Vector shuffleMask;
+            Vector carry1;
+            Vector carry2;
+            if constexpr (intrinsicType == 1) {
+                shuffleMask = componentSize == 1 ? _UV_SHUFFLE_MASK_M128_C1 : _UV_SHUFFLE_MASK_M128_C2;
+                carry1 = componentSize == 1 ? _mm_set1_epi8(src1[0]) : _mm_set1_epi16(reinterpret_cast<const uint16_t *>(src1)[0]);
+                carry2 = componentSize == 1 ? _mm_set1_epi8(src2[0]) : _mm_set1_epi16(reinterpret_cast<const uint16_t *>(src2)[0]);
+            } else if constexpr (intrinsicType == 2) {
+                shuffleMask = _mm256_broadcastsi128_si256(componentSize == 1 ? _UV_SHUFFLE_MASK_M128_C1 : _UV_SHUFFLE_MASK_M128_C2);
+                carry1 = componentSize == 1 ? _mm256_set1_epi8(src1[0]) : _mm256_set1_epi16(reinterpret_cast<const uint16_t *>(src1)[0]);
+                carry2 = componentSize == 1 ? _mm256_set1_epi8(src2[0]) : _mm256_set1_epi16(reinterpret_cast<const uint16_t *>(src2)[0]);
+            }
+
+            // carry holds the odd samples of the previous cycle, starting with the left edge replicated
+            const auto Downsample = [&shuffleMask](const Vector *srcLine, Vector &carry) -> Vector {
+                if constexpr (intrinsicType == 1) {
+                    const __m128i srcShuffle1 = _mm_shuffle_epi8(_mm_loadu_si128(srcLine), shuffleMask);
+                    const __m128i srcShuffle2 = _mm_shuffle_epi8(_mm_loadu_si128(srcLine + 1), shuffleMask);
+                    const __m128i evenVec = _mm_unpacklo_epi64(srcShuffle1, srcShuffle2);
+                    const __m128i oddVec = _mm_unpackhi_epi64(srcShuffle1, srcShuffle2);
+                    const __m128i prevOddVec = _mm_alignr_epi8(oddVec, carry, 16 - componentSize);
+                    carry = oddVec;
+
+                    return Average<1, componentSize>(evenVec, Average<1, componentSize>(prevOddVec, oddVec));
+                } else if constexpr (intrinsicType == 2) {
+                    // PSHUFB works within each lane, so the quadwords are permuted to gather the even and odd samples in each half
+                    const __m256i srcShuffle1 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_loadu_si256(srcLine), shuffleMask), _UV_PERMUTE_INDEX);
+                    const __m256i srcShuffle2 = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(_mm256_loadu_si256(srcLine + 1), shuffleMask), _UV_PERMUTE_INDEX);
+                    const __m256i evenVec = _mm256_permute2x128_si256(srcShuffle1, srcShuffle2, 0x20);
+                    const __m256i oddVec = _mm256_permute2x128_si256(srcShuffle1, srcShuffle2, 0x31);
+                    const __m256i prevOddVec = _mm256_alignr_epi8(oddVec, _mm256_permute2x128_si256(carry, oddVec, 0x21), 16 - componentSize);
+                    carry = oddVec;
+
+                    return Average<2, componentSize>(evenVec, Average<2, componentSize>(prevOddVec, oddVec));
+                }
+            };
+
+            const Vector *src1Line = reinterpret_cast<const Vector *>(src1);
+            const Vector *src2Line = reinterpret_cast<const Vector *>(src2);
+
+            for (int i = 0; i < cycles; ++i) {
+                const Vector dst1Vec = LeftShift(Downsample(src1Line, carry1));
+                const Vector dst2Vec = LeftShift(Downsample(src2Line, carry2));
+                Interleave(dst1Vec, dst2Vec, dstLine);
+
+                src1Line += 2;
+                src2Line += 2;
+            }
+        } else if constexpr (intrinsicType == 1 || intrinsicType == 2) {
+            const auto Upsample = [](const BYTE *srcLine, Vector &dstVec1, Vector &dstVec2) -> void {
+                if constexpr (intrinsicType == 1) {
+                    const __m128i srcVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine));
+                    const __m128i nextVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine + componentSize));
+                    const __m128i averageVec = Average<1, componentSize>(srcVec, nextVec);
+
+                    if constexpr (componentSize == 1) {
+                        dstVec1 = _mm_unpacklo_epi8(srcVec, averageVec);
+                        dstVec2 = _mm_unpackhi_epi8(srcVec, averageVec);
+                    } else {
+                        dstVec1 = _mm_unpacklo_epi16(srcVec, averageVec);
+                        dstVec2 = _mm_unpackhi_epi16(srcVec, averageVec);
+                    }
+                } else if constexpr (intrinsicType == 2) {
+                    const __m256i srcVec = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcLine));
+                    const __m256i nextVec = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcLine + componentSize));
+                    const __m256i averageVec = Average<2, componentSize>(srcVec, nextVec);
+
+                    __m256i dstVecLo;
+                    __m256i dstVecHi;
+                    if constexpr (componentSize == 1) {
+                        dstVecLo = _mm256_unpacklo_epi8(srcVec, averageVec);
+                        dstVecHi = _mm256_unpackhi_epi8(srcVec, averageVec);
+                    } else {
+                        dstVecLo = _mm256_unpacklo_epi16(srcVec, averageVec);
+                        dstVecHi = _mm256_unpackhi_epi16(srcVec, averageVec);
+                    }
+                    dstVec1 = _mm256_permute2x128_si256(dstVecLo, dstVecHi, 0x20);
+                    dstVec2 = _mm256_permute2x128_si256(dstVecLo, dstVecHi, 0x31);
+                }
+            };
+
+            for (int i = 0; i < cycles; ++i) {
+                Vector dst1Vec1;
+                Vector dst1Vec2;
+                Vector dst2Vec1;
+                Vector dst2Vec2;
+                Upsample(src1 + i * sizeof(Vector), dst1Vec1, dst1Vec2);
+                Upsample(src2 + i * sizeof(Vector), dst2Vec1, dst2Vec2);
+                Interleave(LeftShift(dst1Vec1), LeftShift(dst2Vec1), dstLine);
+                Interleave(LeftShift(dst1Vec2), LeftShift(dst2Vec2), dstLine);
+            }
+        }
+
+        const std::array srcTails = { reinterpret_cast<const Component *>(src1), reinterpret_cast<const Component *>(src2) };
+        Component *dstTail = reinterpret_cast<Component *>(dst);
+        const int lastSrc = srcWidth - 1;
+        for (int x = cycles * SAMPLES_PER_VECTOR * (isDownsampling ? 1 : 2); x < width; ++x) {
+            for (size_t p = 0; p < srcTails.size(); ++p) {
+                const Component *srcTail = srcTails[p];
+                int dstVal;
+                if constexpr (isDownsampling) {
+                    const int center = std::min(x * 2, lastSrc);
+                    dstVal = Average<0, componentSize>(static_cast<int>(srcTail[center]),
+                                                       Average<0, componentSize>(static_cast<int>(srcTail[std::max(center - 1, 0)]), static_cast<int>(srcTail[std::min(center + 1, lastSrc)])));
+                } else if (x % 2 == 0) {
+                    dstVal = srcTail[std::min(x / 2, lastSrc)];
+                } else {
+                    dstVal = Average<0, componentSize>(static_cast<int>(srcTail[std::min(x / 2, lastSrc)]), static_cast<int>(srcTail[std::min(x / 2 + 1, lastSrc)]));
+                }
+
+                if constexpr (componentSize == 2) {
+                    dstVal <<= leftShiftSize;
+                }
+                dstTail[x * 2 + p] = static_cast<Component>(dstVal);
+            }
+        }
+    }
+
+    /*
+     * Copy with streaming loads, which are much faster than ordinary loads on write-combined or uncached source.
+     * The source buffer and its stride must be aligned to the vector size.
+     */
+    template <int intrinsicType>
+    static constexpr auto StreamLoadCopy(const BYTE *src, int srcStride, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i, std::conditional_t<intrinsicType == 2, __m256i, __m512i>>;
+        const int cycles = DivideRoundUp(rowSize, sizeof(Vector));
+
+        for (int y = 0; y < height; ++y) {
+            if constexpr (intrinsicType >= 1 && intrinsicType <= 3) {
+                // some versions of the intrinsic headers declare the streaming load functions with non-const pointer
+                Vector *srcLine = reinterpret_cast<Vector *>(const_cast<BYTE *>(src));
+                BYTE *dstLine = dst;
+
+                for (int i = 0; i < cycles; ++i) {
+                    if constexpr (intrinsicType == 1) {
+                        _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine), _mm_stream_load_si128(srcLine++));
+                    } else if constexpr (intrinsicType == 2) {
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstLine), _mm256_stream_load_si256(srcLine++));
+                    } else {
+                        _mm512_storeu_si512(dstLine, _mm512_stream_load_si512(srcLine++));
+                    }
+                    dstLine += sizeof(Vector);
+                }
+            } else {
+                memcpy(dst, src, rowSize);
+            }
+
+            src += srcStride;
+            dst += dstStride;
+        }
+    }
+
+    static constexpr auto OffsetRows(std::array<BYTE *, 3> slices, const std::array<int, 3> &strides, int rows) -> std::array<BYTE *, 3> {
+        for (size_t p = 0; p < slices.size(); ++p) {
+            slices[p] += static_cast<ptrdiff_t>(rows) * strides[p];
+        }
+        return slices;
+    }
+
+    /*
+     * Packed 3-component pixels are processed in 48-byte blocks, 16 pixels for 8-bit and 8 pixels for 16-bit components.
+     * Each 16-byte part of the destination block gathers its bytes from the three parts of the source block with PSHUFB and ORs them together.
+     * AVX2 processes two blocks at once, one in each 128-bit lane, thus no cross-lane permute is needed.
+     * The pixels after the last whole block, and all pixels for non-SIMD, are processed one at a time.
+     */
+    template <int intrinsicType>
+    using BlockVector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+
+    template <int intrinsicType>
+    static constexpr auto BroadcastBlockShuffleMasks(const BlockShuffleMasks &masks) -> std::array<std::array<BlockVector<intrinsicType>, 3>, 3> {
+        std::array<std::array<BlockVector<intrinsicType>, 3>, 3> ret;
+
+        for (int dstPart = 0; dstPart < 3; ++dstPart) {
+            for (int srcPart = 0; srcPart < 3; ++srcPart) {
+                if constexpr (intrinsicType == 2) {
+                    ret[dstPart][srcPart] = _mm256_broadcastsi128_si256(masks[dstPart][srcPart]);
+                } else {
+                    ret[dstPart][srcPart] = masks[dstPart][srcPart];
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    template <int intrinsicType>
+    static constexpr auto ShuffleBlock(const std::array<BlockVector<intrinsicType>, 3> &srcVecs, const std::array<std::array<BlockVector<intrinsicType>, 3>, 3> &masks) -> std::array<BlockVector<intrinsicType>, 3> {
+        std::array<BlockVector<intrinsicType>, 3> ret;
+
+        for (int dstPart = 0; dstPart < 3; ++dstPart) {
+            if constexpr (intrinsicType == 2) {
+                ret[dstPart] = _mm256_or_si256(_mm256_or_si256(_mm256_shuffle_epi8(srcVecs[0], masks[dstPart][0]), _mm256_shuffle_epi8(srcVecs[1], masks[dstPart][1])), _mm256_shuffle_epi8(srcVecs[2], masks[dstPart][2]));
+            } else {
+                ret[dstPart] = _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(srcVecs[0], masks[dstPart][0]), _mm_shuffle_epi8(srcVecs[1], masks[dstPart][1])), _mm_shuffle_epi8(srcVecs[2], masks[dstPart][2]));
+            }
+        }
+
+        return ret;
+    }
+
+    // for AVX2, the lower lanes hold the first block, and the upper lanes hold the next block
+    template <int intrinsicType>
+    static constexpr auto LoadPackedBlock(const BYTE *src) -> std::array<BlockVector<intrinsicType>, 3> {
+        std::array<BlockVector<intrinsicType>, 3> ret;
+
+        for (int part = 0; part < 3; ++part) {
+            const __m128i *partSrc = reinterpret_cast<const __m128i *>(src) + part;
+            if constexpr (intrinsicType == 2) {
+                ret[part] = _mm256_loadu2_m128i(partSrc + 3, partSrc);
+            } else {
+                ret[part] = _mm_loadu_si128(partSrc);
+            }
+        }
+
+        return ret;
+    }
+
+    template <int intrinsicType>
+    static constexpr auto StorePackedBlock(BYTE *dst, const std::array<BlockVector<intrinsicType>, 3> &vecs) -> void {
+        for (int part = 0; part < 3; ++part) {
+            __m128i *partDst = reinterpret_cast<__m128i *>(dst) + part;
+            if constexpr (intrinsicType == 2) {
+                _mm256_storeu2_m128i(partDst + 3, partDst, vecs[part]);
+            } else {
+                _mm_storeu_si128(partDst, vecs[part]);
+            }
+        }
+    }
+
+    template <int intrinsicType, int componentSize>
+    static constexpr auto DeinterleaveRGB(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        using Vector = BlockVector<intrinsicType>;
+
+        constexpr bool isSimd = intrinsicType == 1 || intrinsicType == 2;
+        constexpr int blockSize = sizeof(Vector) * 3;
+        constexpr int pixelSize = componentSize * 3;
+
+        std::array<std::array<Vector, 3>, 3> masks {};
+        if constexpr (isSimd) {
+            masks = BroadcastBlockShuffleMasks<intrinsicType>(componentSize == 1 ? _RGB24_DEINTERLEAVE_MASKS : _RGB48_DEINTERLEAVE_MASKS);
+        }
+
+        const int cycles = isSimd ? rowSize / blockSize : 0;
+        const int tailPixels = (rowSize - cycles * blockSize) / pixelSize;
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLine = src;
+            std::array<BYTE *, 3> dstsLine = dsts;
+
+            if constexpr (isSimd) {
+                for (int i = 0; i < cycles; ++i) {
+                    const std::array<Vector, 3> dstVecs = ShuffleBlock<intrinsicType>(LoadPackedBlock<intrinsicType>(srcLine), masks);
+                    srcLine += blockSize;
+
+                    for (int p = 0; p < 3; ++p) {
+                        if constexpr (intrinsicType == 2) {
+                            _mm256_storeu_si256(reinterpret_cast<Vector *>(dstsLine[p]), dstVecs[p]);
+                        } else {
+                            _mm_storeu_si128(reinterpret_cast<Vector *>(dstsLine[p]), dstVecs[p]);
+                        }
+                        dstsLine[p] += sizeof(Vector);
+                    }
+                }
+            }
+
+            for (int i = 0; i < tailPixels; ++i) {
+                for (int p = 0; p < 3; ++p) {
+                    memcpy(dstsLine[p], srcLine, componentSize);
+                    dstsLine[p] += componentSize;
+                    srcLine += componentSize;
+                }
+            }
+
+            src += srcStride;
+            for (size_t p = 0; p < dsts.size(); ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+    }
+
+    template <int intrinsicType, int componentSize>
+    static constexpr auto InterleaveRGB(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        using Vector = BlockVector<intrinsicType>;
+
+        constexpr bool isSimd = intrinsicType == 1 || intrinsicType == 2;
+        constexpr int blockSize = sizeof(Vector) * 3;
+        constexpr int pixelSize = componentSize * 3;
+
+        std::array<std::array<Vector, 3>, 3> masks {};
+        if constexpr (isSimd) {
+            masks = BroadcastBlockShuffleMasks<intrinsicType>(componentSize == 1 ? _RGB24_INTERLEAVE_MASKS : _RGB48_INTERLEAVE_MASKS);
+        }
+
+        const int cycles = isSimd ? rowSize / blockSize : 0;
+        const int tailPixels = (rowSize - cycles * blockSize) / pixelSize;
+
+        for (int y = 0; y < height; ++y) {
+            std::array<const BYTE *, 3> srcsLine = srcs;
+            BYTE *dstLine = dst;
+
+            if constexpr (isSimd) {
+                for (int i = 0; i < cycles; ++i) {
+                    std::array<Vector, 3> srcVecs;
+                    for (int p = 0; p < 3; ++p) {
+                        if constexpr (intrinsicType == 2) {
+                            srcVecs[p] = _mm256_loadu_si256(reinterpret_cast<const Vector *>(srcsLine[p]));
+                        } else {
+                            srcVecs[p] = _mm_loadu_si128(reinterpret_cast<const Vector *>(srcsLine[p]));
+                        }
+                        srcsLine[p] += sizeof(Vector);
+                    }
+
+                    StorePackedBlock<intrinsicType>(dstLine, ShuffleBlock<intrinsicType>(srcVecs, masks));
+                    dstLine += blockSize;
+                }
+            }
+
+            for (int i = 0; i < tailPixels; ++i) {
+                for (int p = 0; p < 3; ++p) {
+                    memcpy(dstLine, srcsLine[p], componentSize);
+                    dstLine += componentSize;
+                    srcsLine[p] += componentSize;
+                }
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * Swap the first and third 16-bit components of each packed pixel while copying from src to dst, i.e. R-G-B(-A) <-> B-G-R(-A).
+     * 3-component pixels are processed in 48-byte blocks like DeinterleaveRGB(). 4-component pixels never cross the 128-bit lanes,
+     * thus one PSHUFB per vector is enough.
+     */
+    template <int intrinsicType, int numComponents>
+    static constexpr auto SwapRedBlue(const BYTE *src, int srcStride, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        using Vector = std::conditional_t<numComponents == 3, BlockVector<intrinsicType>
+                     , std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i, __m512i>>>;
+
+        constexpr bool isSimd = intrinsicType >= 1 && intrinsicType <= (numComponents == 3 ? 2 : 3);
+        constexpr int blockSize = sizeof(Vector) * (numComponents == 3 ? 3 : 1);
+        constexpr int pixelSize = sizeof(uint16_t) * numComponents;
+
+        std::array<std::array<BlockVector<intrinsicType>, 3>, 3> blockMasks {};
+        Vector swapMask {};
+        if constexpr (isSimd && numComponents == 3) {
+            blockMasks = BroadcastBlockShuffleMasks<intrinsicType>(_RGB48_SWAP_MASKS);
+        } else if constexpr (intrinsicType == 1) {
+            swapMask = _RGBA64_SWAP_MASK;
+        } else if constexpr (intrinsicType == 2) {
+            swapMask = _mm256_broadcastsi128_si256(_RGBA64_SWAP_MASK);
+        } else if constexpr (intrinsicType == 3) {
+            swapMask = _mm512_broadcast_i32x4(_RGBA64_SWAP_MASK);
+        }
+
+        const int cycles = isSimd ? rowSize / blockSize : 0;
+        const int tailPixels = (rowSize - cycles * blockSize) / pixelSize;
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLine = src;
+            BYTE *dstLine = dst;
+
+            if constexpr (isSimd) {
+                for (int i = 0; i < cycles; ++i) {
+                    if constexpr (numComponents == 3) {
+                        StorePackedBlock<intrinsicType>(dstLine, ShuffleBlock<intrinsicType>(LoadPackedBlock<intrinsicType>(srcLine), blockMasks));
+                    } else if constexpr (intrinsicType == 1) {
+                        _mm_storeu_si128(reinterpret_cast<Vector *>(dstLine), _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const Vector *>(srcLine)), swapMask));
+                    } else if constexpr (intrinsicType == 2) {
+                        _mm256_storeu_si256(reinterpret_cast<Vector *>(dstLine), _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const Vector *>(srcLine)), swapMask));
+                    } else if constexpr (intrinsicType == 3) {
+                        _mm512_storeu_si512(dstLine, _mm512_shuffle_epi8(_mm512_loadu_si512(srcLine), swapMask));
+                    }
+                    srcLine += blockSize;
+                    dstLine += blockSize;
+                }
+            }
+
+            for (int i = 0; i < tailPixels; ++i) {
+                std::array<uint16_t, numComponents> pixel;
+                memcpy(pixel.data(), srcLine, pixelSize);
+                std::swap(pixel[0], pixel[2]);
+                memcpy(dstLine, pixel.data(), pixelSize);
+                srcLine += pixelSize;
+                dstLine += pixelSize;
+            }
+
+            src += srcStride;
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * SSE4: process one plane at a time by zeroing all other planes, shuffle it from different pixels together, and fix the position by right shifting
+     * AVX2: same as SSE4 in each lane, then move the results of both lanes together. The rest of the row is processed like SSE4
+     * AVX-512: shift each plane to the least significant side, zero all other planes and truncate the 32-bit integers to 16-bit
+     */
+    template <int intrinsicType>
+    static constexpr auto DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , uint32_t>>>;
+
+        const auto DeinterleaveM128 = [](const __m128i &srcVec, std::array<BYTE *, 3> &dstsLine) -> void {
+            const __m128i dataVec1 = _mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_1), _Y410_SHUFFLE_MASK_1);
+            const __m128i dataVec2 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_2), _Y410_SHUFFLE_MASK_2), 2);
+            const __m128i dataVec3 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_3), _Y410_SHUFFLE_MASK_3), 4);
+
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[0]), dataVec1);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[1]), dataVec2);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[2]), dataVec3);
+            for (BYTE *&dstLine : dstsLine) {
+                dstLine += sizeof(__m128i) / 2;
+            }
+        };
+
+        // AVX2 and AVX-512 only process whole vectors in the main loop
+        const int cycles = intrinsicType <= 1 ? DivideRoundUp(rowSize, sizeof(Vector)) : rowSize / static_cast<int>(sizeof(Vector));
+        const int tailSize = intrinsicType <= 1 ? 0 : rowSize % static_cast<int>(sizeof(Vector));
+
+        for (int y = 0; y < height; ++y) {
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+            std::array<BYTE *, 3> dstsLine = dsts;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 0) {
+                    const Vector srcVal = *srcLine++;
+
+                    for (int p = 0; p < 3; ++p) {
+                        *reinterpret_cast<uint16_t *>(dstsLine[p]) = static_cast<uint16_t>(srcVal >> (p * 10) & 1023);
+                        dstsLine[p] += sizeof(uint16_t);
+                    }
+                } else if constexpr (intrinsicType == 1) {
+                    DeinterleaveM128(*srcLine++, dstsLine);
+                } else if constexpr (intrinsicType == 2) {
+                    const Vector srcVec = _mm256_loadu_si256(srcLine++);
+
+                    const Vector dataVec1 = _mm256_shuffle_epi8(_mm256_and_si256(srcVec, _mm256_broadcastsi128_si256(_Y410_AND_MASK_1)), _mm256_broadcastsi128_si256(_Y410_SHUFFLE_MASK_1));
+                    const Vector dataVec2 = _mm256_srli_epi32(_mm256_shuffle_epi8(_mm256_and_si256(srcVec, _mm256_broadcastsi128_si256(_Y410_AND_MASK_2)), _mm256_broadcastsi128_si256(_Y410_SHUFFLE_MASK_2)), 2);
+                    const Vector dataVec3 = _mm256_srli_epi32(_mm256_shuffle_epi8(_mm256_and_si256(srcVec, _mm256_broadcastsi128_si256(_Y410_AND_MASK_3)), _mm256_broadcastsi128_si256(_Y410_SHUFFLE_MASK_3)), 4);
+
+                    // the results are in the lower 64 bits of each lane
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[0]), _mm256_castsi256_si128(_mm256_permute4x64_epi64(dataVec1, 0b1000)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[1]), _mm256_castsi256_si128(_mm256_permute4x64_epi64(dataVec2, 0b1000)));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[2]), _mm256_castsi256_si128(_mm256_permute4x64_epi64(dataVec3, 0b1000)));
+                    for (BYTE *&dstLine : dstsLine) {
+                        dstLine += sizeof(Vector) / 2;
+                    }
+                } else if constexpr (intrinsicType == 3) {
+                    const Vector srcVec = _mm512_loadu_si512(srcLine++);
+                    const Vector componentMask = _mm512_set1_epi32(1023);
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstsLine[0]), _mm512_cvtepi32_epi16(_mm512_and_si512(srcVec, componentMask)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstsLine[1]), _mm512_cvtepi32_epi16(_mm512_and_si512(_mm512_srli_epi32(srcVec, 10), componentMask)));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstsLine[2]), _mm512_cvtepi32_epi16(_mm512_and_si512(_mm512_srli_epi32(srcVec, 20), componentMask)));
+                    for (BYTE *&dstLine : dstsLine) {
+                        dstLine += sizeof(Vector) / 2;
+                    }
+                }
+            }
+
+            if constexpr (intrinsicType == 2) {
+                for (int i = 0; i < DivideRoundUp(tailSize, sizeof(__m128i)); ++i) {
+                    DeinterleaveM128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine) + i), dstsLine);
+                }
+            } else if constexpr (intrinsicType == 3) {
+                if (tailSize > 0) {
+                    const __mmask16 tailMask = static_cast<__mmask16>((1U << DivideRoundUp(tailSize, sizeof(uint32_t))) - 1);
+                    const Vector srcVec = _mm512_maskz_loadu_epi32(tailMask, srcLine);
+                    const Vector componentMask = _mm512_set1_epi32(1023);
+
+                    _mm512_mask_cvtepi32_storeu_epi16(dstsLine[0], tailMask, _mm512_and_si512(srcVec, componentMask));
+                    _mm512_mask_cvtepi32_storeu_epi16(dstsLine[1], tailMask, _mm512_and_si512(_mm512_srli_epi32(srcVec, 10), componentMask));
+                    _mm512_mask_cvtepi32_storeu_epi16(dstsLine[2], tailMask, _mm512_and_si512(_mm512_srli_epi32(srcVec, 20), componentMask));
+                }
+            }
+
+            src += srcStride;
+            for (size_t p = 0; p < dsts.size(); ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+    }
+
+    /*
+     * Expand each 16-bit integer to 32-bit, left shift to right position and OR them all.
+     * Due the expansion, each output vector only takes half the vector size from each source.
+     * AVX2 processes the rest of the row like SSE4, AVX-512 with masked loads and stores.
+     */
+    template <int intrinsicType>
+    static constexpr auto InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        using Vector = std::conditional_t<intrinsicType == 1, __m128i
+                     , std::conditional_t<intrinsicType == 2, __m256i
+                     , std::conditional_t<intrinsicType == 3, __m512i
+                     , uint32_t>>>;
+
+        const auto InterleaveM128 = [](std::array<const BYTE *, 3> &srcsLine, BYTE *&dstLine) -> void {
+            const __m128i vec1 = _mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[0])));
+            const __m128i vec2 = _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[1]))), 10);
+            const __m128i vec3 = _mm_slli_epi32(_mm_cvtepu16_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[2]))), 20);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine), _mm_or_si128(_mm_or_si128(vec1, vec2), vec3));
+
+            for (const BYTE *&srcLine : srcsLine) {
+                srcLine += sizeof(__m128i) / 2;
+            }
+            dstLine += sizeof(__m128i);
+        };
+
+        // AVX2 and AVX-512 only process whole vectors in the main loop
+        const int cycles = intrinsicType <= 1 ? DivideRoundUp(rowSize, sizeof(Vector)) : rowSize / static_cast<int>(sizeof(Vector));
+        const int tailSize = intrinsicType <= 1 ? 0 : rowSize % static_cast<int>(sizeof(Vector));
+
+        for (int y = 0; y < height; ++y) {
+            std::array<const BYTE *, 3> srcsLine = srcs;
+            BYTE *dstLine = dst;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 0) {
+                    Vector dstVal = 0;
+
+                    for (int p = 0; p < 3; ++p) {
+                        dstVal |= static_cast<Vector>(*reinterpret_cast<const uint16_t *>(srcsLine[p])) << (p * 10);
+                        srcsLine[p] += sizeof(uint16_t);
+                    }
+
+                    *reinterpret_cast<Vector *>(dstLine) = dstVal;
+                    dstLine += sizeof(Vector);
+                } else if constexpr (intrinsicType == 1) {
+                    InterleaveM128(srcsLine, dstLine);
+                } else if constexpr (intrinsicType == 2) {
+                    const Vector vec1 = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[0])));
+                    const Vector vec2 = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[1]))), 10);
+                    const Vector vec3 = _mm256_slli_epi32(_mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[2]))), 20);
+                    _mm256_storeu_si256(reinterpret_cast<Vector *>(dstLine), _mm256_or_si256(_mm256_or_si256(vec1, vec2), vec3));
+
+                    for (const BYTE *&srcLine : srcsLine) {
+                        srcLine += sizeof(Vector) / 2;
+                    }
+                    dstLine += sizeof(Vector);
+                } else if constexpr (intrinsicType == 3) {
+                    const Vector vec1 = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcsLine[0])));
+                    const Vector vec2 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcsLine[1]))), 10);
+                    const Vector vec3 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcsLine[2]))), 20);
+                    _mm512_storeu_si512(dstLine, _mm512_ternarylogic_epi32(vec1, vec2, vec3, 0xfe));
+
+                    for (const BYTE *&srcLine : srcsLine) {
+                        srcLine += sizeof(Vector) / 2;
+                    }
+                    dstLine += sizeof(Vector);
+                }
+            }
+
+            if constexpr (intrinsicType == 2) {
+                for (int i = 0; i < DivideRoundUp(tailSize, sizeof(__m128i)); ++i) {
+                    InterleaveM128(srcsLine, dstLine);
+                }
+            } else if constexpr (intrinsicType == 3) {
+                if (tailSize > 0) {
+                    const __mmask16 tailMask = static_cast<__mmask16>((1U << DivideRoundUp(tailSize, sizeof(uint32_t))) - 1);
+                    const Vector vec1 = _mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(tailMask, srcsLine[0]));
+                    const Vector vec2 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(tailMask, srcsLine[1])), 10);
+                    const Vector vec3 = _mm512_slli_epi32(_mm512_cvtepu16_epi32(_mm256_maskz_loadu_epi16(tailMask, srcsLine[2])), 20);
+                    _mm512_mask_storeu_epi32(dstLine, tailMask, _mm512_ternarylogic_epi32(vec1, vec2, vec3, 0xfe));
+                }
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * Packed 4:2:2 in the Y0 U0 Y1 V0 order, such as YUY2, Y210 and Y216, or the U0 Y0 V0 Y1 order of UYVY when isChromaFirst.
+     * Each vector is shuffled in lane into Y | U | V, then the Y of two vectors are unpacked together, as are the U and V.
+     * For AVX2, the lanes of the results are permuted back into the pixel order.
+     * dsts are the Y, U and V planes. rightShiftSize is for the MSB-aligned samples of Y210.
+     */
+    template <int intrinsicType, int componentSize, int rightShiftSize = 0, bool isChromaFirst = false>
+    static constexpr auto DeinterleaveYUYV(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
+        static_assert(componentSize == 1 || !isChromaFirst, "Only 8-bit components are supported for the U Y V Y order");
+
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<componentSize == 1, uint8_t, uint16_t>;
+
+        __m128i shuffleMask;
+        if constexpr (componentSize == 2) {
+            shuffleMask = _YUYV_SHUFFLE_MASK_C2;
+        } else if constexpr (isChromaFirst) {
+            shuffleMask = _UYVY_SHUFFLE_MASK_C1;
+        } else {
+            shuffleMask = _YUYV_SHUFFLE_MASK_C1;
+        }
+
+        const auto Prepare = [shuffleMask](const Vector *srcVec) -> Vector {
+            if constexpr (intrinsicType == 2) {
+                Vector vec = _mm256_loadu_si256(srcVec);
+                if constexpr (rightShiftSize != 0) {
+                    vec = _mm256_srli_epi16(vec, rightShiftSize);
+                }
+                return _mm256_shuffle_epi8(vec, _mm256_broadcastsi128_si256(shuffleMask));
+            } else {
+                Vector vec = _mm_loadu_si128(srcVec);
+                if constexpr (rightShiftSize != 0) {
+                    vec = _mm_srli_epi16(vec, rightShiftSize);
+                }
+                return _mm_shuffle_epi8(vec, shuffleMask);
+            }
+        };
+
+        constexpr int pixelPairSize = componentSize * 4;
+        constexpr int lumaIndex = isChromaFirst ? 1 : 0;
+        constexpr int chromaIndex = isChromaFirst ? 0 : 1;
+        // each cycle processes two source vectors, which is more than the input stride alignment guarantees, so the rest goes to the tail
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? rowSize / static_cast<int>(sizeof(Vector) * 2) : 0;
+        const int tailPixelPairs = (rowSize - cycles * static_cast<int>(sizeof(Vector) * 2)) / pixelPairSize;
+
+        for (int y = 0; y < height; ++y) {
+            const Vector *srcLine = reinterpret_cast<const Vector *>(src);
+            std::array<BYTE *, 3> dstsLine = dsts;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 2) {
+                    const Vector vec1 = Prepare(srcLine++);
+                    const Vector vec2 = Prepare(srcLine++);
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstsLine[0]), _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(vec1, vec2), _UV_PERMUTE_INDEX));
+                    const __m256i uvVec = _mm256_permutevar8x32_epi32(_mm256_unpackhi_epi32(vec1, vec2), _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[1]), _mm256_castsi256_si128(uvVec));
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[2]), _mm256_extracti128_si256(uvVec, 1));
+                } else if constexpr (intrinsicType == 1) {
+                    const Vector vec1 = Prepare(srcLine++);
+                    const Vector vec2 = Prepare(srcLine++);
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[0]), _mm_unpacklo_epi64(vec1, vec2));
+                    const __m128i uvVec = _mm_unpackhi_epi32(vec1, vec2);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[1]), uvVec);
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[2]), _mm_unpackhi_epi64(uvVec, uvVec));
+                }
+
+                dstsLine[0] += sizeof(Vector);
+                dstsLine[1] += sizeof(Vector) / 2;
+                dstsLine[2] += sizeof(Vector) / 2;
+            }
+
+            const BYTE *srcTail = reinterpret_cast<const BYTE *>(srcLine);
+            for (int i = 0; i < tailPixelPairs; ++i) {
+                std::array<Component, 4> samples;
+                memcpy(samples.data(), srcTail, pixelPairSize);
+                for (Component &sample : samples) {
+                    sample >>= rightShiftSize;
+                }
+
+                memcpy(dstsLine[0], &samples[lumaIndex], componentSize);
+                memcpy(dstsLine[0] + componentSize, &samples[lumaIndex + 2], componentSize);
+                memcpy(dstsLine[1], &samples[chromaIndex], componentSize);
+                memcpy(dstsLine[2], &samples[chromaIndex + 2], componentSize);
+
+                srcTail += pixelPairSize;
+                dstsLine[0] += componentSize * 2;
+                dstsLine[1] += componentSize;
+                dstsLine[2] += componentSize;
+            }
+
+            src += srcStride;
+            for (size_t p = 0; p < dsts.size(); ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+    }
+
+    /*
+     * Unpack U and V together, then unpack Y with the result, which gives the Y0 U0 Y1 V0 order, or the reverse for U0 Y0 V0 Y1.
+     * For AVX2, the U and V of each lane are prepared with SSE, and the lanes of the output are permuted back into the pixel order.
+     * leftShiftSize is for the MSB-aligned samples of Y210.
+     */
+    template <int intrinsicType, int componentSize, int leftShiftSize = 0, bool isChromaFirst = false>
+    static constexpr auto InterleaveYUYV(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
+        static_assert(componentSize == 1 || !isChromaFirst, "Only 8-bit components are supported for the U Y V Y order");
+
+        using Vector = std::conditional_t<intrinsicType == 2, __m256i, __m128i>;
+        using Component = std::conditional_t<componentSize == 1, uint8_t, uint16_t>;
+
+        const auto UnpackLo128 = [](__m128i a, __m128i b) -> __m128i {
+            return componentSize == 1 ? _mm_unpacklo_epi8(a, b) : _mm_unpacklo_epi16(a, b);
+        };
+        const auto UnpackHi128 = [](__m128i a, __m128i b) -> __m128i {
+            return componentSize == 1 ? _mm_unpackhi_epi8(a, b) : _mm_unpackhi_epi16(a, b);
+        };
+        const auto UnpackLo256 = [](__m256i a, __m256i b) -> __m256i {
+            return componentSize == 1 ? _mm256_unpacklo_epi8(a, b) : _mm256_unpacklo_epi16(a, b);
+        };
+        const auto UnpackHi256 = [](__m256i a, __m256i b) -> __m256i {
+            return componentSize == 1 ? _mm256_unpackhi_epi8(a, b) : _mm256_unpackhi_epi16(a, b);
+        };
+
+        constexpr int pixelPairSize = componentSize * 4;
+        constexpr int lumaIndex = isChromaFirst ? 1 : 0;
+        constexpr int chromaIndex = isChromaFirst ? 0 : 1;
+        // each cycle consumes one vector of Y and writes two vectors
+        const int cycles = intrinsicType == 1 || intrinsicType == 2 ? DivideRoundUp(rowSize, sizeof(Vector) * 2) : 0;
+        const int tailPixelPairs = intrinsicType == 1 || intrinsicType == 2 ? 0 : rowSize / pixelPairSize;
+
+        for (int y = 0; y < height; ++y) {
+            std::array<const BYTE *, 3> srcsLine = srcs;
+            BYTE *dstLine = dst;
+
+            for (int i = 0; i < cycles; ++i) {
+                if constexpr (intrinsicType == 2) {
+                    const __m128i uVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[1]));
+                    const __m128i vVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[2]));
+                    const __m256i uvVec = _mm256_set_m128i(UnpackHi128(uVec, vVec), UnpackLo128(uVec, vVec));
+                    const __m256i yVec = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcsLine[0]));
+
+                    __m256i dstVec1;
+                    __m256i dstVec2;
+                    if constexpr (isChromaFirst) {
+                        dstVec1 = UnpackLo256(uvVec, yVec);
+                        dstVec2 = UnpackHi256(uvVec, yVec);
+                    } else {
+                        dstVec1 = UnpackLo256(yVec, uvVec);
+                        dstVec2 = UnpackHi256(yVec, uvVec);
+                    }
+                    if constexpr (leftShiftSize != 0) {
+                        dstVec1 = _mm256_slli_epi16(dstVec1, leftShiftSize);
+                        dstVec2 = _mm256_slli_epi16(dstVec2, leftShiftSize);
+                    }
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstLine), _mm256_permute2x128_si256(dstVec1, dstVec2, 0x20));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstLine) + 1, _mm256_permute2x128_si256(dstVec1, dstVec2, 0x31));
+                } else if constexpr (intrinsicType == 1) {
+                    const __m128i uvVec = UnpackLo128(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[1])), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[2])));
+                    const __m128i yVec = _mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[0]));
+
+                    __m128i dstVec1;
+                    __m128i dstVec2;
+                    if constexpr (isChromaFirst) {
+                        dstVec1 = UnpackLo128(uvVec, yVec);
+                        dstVec2 = UnpackHi128(uvVec, yVec);
+                    } else {
+                        dstVec1 = UnpackLo128(yVec, uvVec);
+                        dstVec2 = UnpackHi128(yVec, uvVec);
+                    }
+                    if constexpr (leftShiftSize != 0) {
+                        dstVec1 = _mm_slli_epi16(dstVec1, leftShiftSize);
+                        dstVec2 = _mm_slli_epi16(dstVec2, leftShiftSize);
+                    }
+
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine), dstVec1);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine) + 1, dstVec2);
+                }
+
+                srcsLine[0] += sizeof(Vector);
+                srcsLine[1] += sizeof(Vector) / 2;
+                srcsLine[2] += sizeof(Vector) / 2;
+                dstLine += sizeof(Vector) * 2;
+            }
+
+            for (int i = 0; i < tailPixelPairs; ++i) {
+                std::array<Component, 4> samples;
+                memcpy(&samples[lumaIndex], srcsLine[0], componentSize);
+                memcpy(&samples[chromaIndex], srcsLine[1], componentSize);
+                memcpy(&samples[lumaIndex + 2], srcsLine[0] + componentSize, componentSize);
+                memcpy(&samples[chromaIndex + 2], srcsLine[2], componentSize);
+                for (Component &sample : samples) {
+                    sample <<= leftShiftSize;
+                }
+                memcpy(dstLine, samples.data(), pixelPairSize);
+
+                srcsLine[0] += componentSize * 2;
+                srcsLine[1] += componentSize;
+                srcsLine[2] += componentSize;
+                dstLine += pixelPairSize;
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+    }
+
+    /*
+     * v210 packs 6 pixels of 4:2:2 in each 16-byte block, as four 32-bit words of three 10-bit samples each:
+     * U0 Y0 V0 | Y1 U1 Y2 | V1 Y3 U2 | Y4 V2 Y5, from the least significant bits of the first word.
+     * Partial blocks at the end of the row are zero-padded, and the stride is aligned to 128 bytes.
+     */
+    static constexpr int V210_BLOCK_PIXELS = 6;
+    static constexpr int V210_BLOCK_SIZE = 16;
+
+    FORCE_INLINE static constexpr auto UnpackV210Block(const BYTE *src, std::array<BYTE *, 3> &dsts, int numPixels) -> void {
+        std::array<uint32_t, 4> words;
+        memcpy(words.data(), src, sizeof(words));
+
+        // samples are in the order of U Y V Y
+        for (int s = 0; s < 12; ++s) {
+            const uint16_t sample = (words[s / 3] >> (s % 3 * 10)) & 1023;
+            const int plane = s % 2 == 1 ? 0 : s % 4 / 2 + 1;
+            const int index = plane == 0 ? s / 2 : s / 4;
+            if (index < (plane == 0 ? numPixels : DivideRoundUp(numPixels, 2))) {
+                memcpy(dsts[plane] + index * sizeof(uint16_t), &sample, sizeof(uint16_t));
+            }
+        }
+
+        dsts[0] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+        dsts[1] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+        dsts[2] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+    }
+
+    FORCE_INLINE static constexpr auto PackV210Block(std::array<const BYTE *, 3> &srcs, BYTE *dst, int numPixels) -> void {
+        std::array<uint32_t, 4> words {};
+
+        for (int s = 0; s < 12; ++s) {
+            const int plane = s % 2 == 1 ? 0 : s % 4 / 2 + 1;
+            const int index = plane == 0 ? s / 2 : s / 4;
+            uint16_t sample = 0;
+            if (index < (plane == 0 ? numPixels : DivideRoundUp(numPixels, 2))) {
+                memcpy(&sample, srcs[plane] + index * sizeof(uint16_t), sizeof(uint16_t));
+            }
+            words[s / 3] |= static_cast<uint32_t>(std::min<uint16_t>(sample, 1023)) << (s % 3 * 10);
+        }
+        memcpy(dst, words.data(), sizeof(words));
+
+        srcs[0] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+        srcs[1] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+        srcs[2] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+    }
+
+    /*
+     * Split each 32-bit word into its three 10-bit samples, narrow them to 16-bit, then gather each plane with PSHUFB.
+     * Y is gathered into one vector, U and V into the lower and upper halves of another.
+     * AVX2 processes two blocks at once, one in each 128-bit lane, then the remaining whole blocks like SSE4.
+     * The stores write past the samples of the block, which are overwritten by the next block. Blocks near the end of the row
+     * where the stores would overflow the row, and all blocks for non-SIMD, are unpacked one sample at a time.
+     * dsts are the Y, U and V planes. width is in pixels.
+     */
+    template <int intrinsicType>
+    static constexpr auto UnpackV210(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int width, int height) -> void {
+        const auto UnpackM128 = [](const __m128i &srcVec, std::array<BYTE *, 3> &dstsLine) -> void {
+            const __m128i componentMask = _mm_set1_epi32(1023);
+            const __m128i vec1 = _mm_and_si128(srcVec, componentMask);
+            const __m128i vec2 = _mm_and_si128(_mm_srli_epi32(srcVec, 10), componentMask);
+            const __m128i vec3 = _mm_and_si128(_mm_srli_epi32(srcVec, 20), componentMask);
+
+            // U0 Y1 V1 Y4 Y0 U1 Y3 V2, and V0 Y2 U2 Y5
+            const __m128i samples1 = _mm_packus_epi32(vec1, vec2);
+            const __m128i samples2 = _mm_packus_epi32(vec3, vec3);
+            const __m128i yVec = _mm_or_si128(_mm_shuffle_epi8(samples1, _V210_UNPACK_Y_MASK_1), _mm_shuffle_epi8(samples2, _V210_UNPACK_Y_MASK_2));
+            const __m128i uvVec = _mm_or_si128(_mm_shuffle_epi8(samples1, _V210_UNPACK_UV_MASK_1), _mm_shuffle_epi8(samples2, _V210_UNPACK_UV_MASK_2));
+
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(dstsLine[0]), yVec);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[1]), uvVec);
+            _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[2]), _mm_unpackhi_epi64(uvVec, uvVec));
+
+            dstsLine[0] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+            dstsLine[1] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+            dstsLine[2] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+        };
+
+        // the block is safe for SIMD when the 16-byte store of Y and the 8-byte stores of U and V stay in the row
+        const int numBlocks = DivideRoundUp(width, V210_BLOCK_PIXELS);
+        const int numSimdBlocks = intrinsicType >= 1 ? std::max(width - 2, 0) / V210_BLOCK_PIXELS : 0;
+        // AVX2 stores 32 bytes of Y
+        const int numDoubleBlocks = intrinsicType == 2 ? std::max(width - 4, 0) / (V210_BLOCK_PIXELS * 2) : 0;
+
+        for (int y = 0; y < height; ++y) {
+            const BYTE *srcLine = src;
+            std::array<BYTE *, 3> dstsLine = dsts;
+            int block = 0;
+
+            if constexpr (intrinsicType == 2) {
+                const __m256i componentMask = _mm256_set1_epi32(1023);
+                const __m256i yMask1 = _mm256_broadcastsi128_si256(_V210_UNPACK_Y_MASK_1);
+                const __m256i yMask2 = _mm256_broadcastsi128_si256(_V210_UNPACK_Y_MASK_2);
+                const __m256i uvMask1 = _mm256_broadcastsi128_si256(_V210_UNPACK_UV_MASK_1);
+                const __m256i uvMask2 = _mm256_broadcastsi128_si256(_V210_UNPACK_UV_MASK_2);
+                // the 6 Y samples of each lane are in the lowest 3 dwords
+                const __m256i yPermuteIndex = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+
+                for (; block < numDoubleBlocks * 2; block += 2) {
+                    const __m256i srcVec = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(srcLine));
+                    srcLine += V210_BLOCK_SIZE * 2;
+
+                    const __m256i vec1 = _mm256_and_si256(srcVec, componentMask);
+                    const __m256i vec2 = _mm256_and_si256(_mm256_srli_epi32(srcVec, 10), componentMask);
+                    const __m256i vec3 = _mm256_and_si256(_mm256_srli_epi32(srcVec, 20), componentMask);
+
+                    const __m256i samples1 = _mm256_packus_epi32(vec1, vec2);
+                    const __m256i samples2 = _mm256_packus_epi32(vec3, vec3);
+                    const __m256i yVec = _mm256_or_si256(_mm256_shuffle_epi8(samples1, yMask1), _mm256_shuffle_epi8(samples2, yMask2));
+                    const __m256i uvVec = _mm256_or_si256(_mm256_shuffle_epi8(samples1, uvMask1), _mm256_shuffle_epi8(samples2, uvMask2));
+                    const __m256i vuVec = _mm256_unpackhi_epi64(uvVec, uvVec);
+
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstsLine[0]), _mm256_permutevar8x32_epi32(yVec, yPermuteIndex));
+                    // the store of the upper lane must come after the lower lane, to overwrite its padding
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[1]), _mm256_castsi256_si128(uvVec));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[1] + V210_BLOCK_PIXELS), _mm256_extracti128_si256(uvVec, 1));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[2]), _mm256_castsi256_si128(vuVec));
+                    _mm_storel_epi64(reinterpret_cast<__m128i *>(dstsLine[2] + V210_BLOCK_PIXELS), _mm256_extracti128_si256(vuVec, 1));
+
+                    dstsLine[0] += V210_BLOCK_PIXELS * 2 * sizeof(uint16_t);
+                    dstsLine[1] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+                    dstsLine[2] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+                }
+            }
+
+            if constexpr (intrinsicType >= 1) {
+                for (; block < numSimdBlocks; ++block) {
+                    UnpackM128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcLine)), dstsLine);
+                    srcLine += V210_BLOCK_SIZE;
+                }
+            }
+
+            for (; block < numBlocks; ++block) {
+                UnpackV210Block(srcLine, dstsLine, std::min(width - block * V210_BLOCK_PIXELS, V210_BLOCK_PIXELS));
+                srcLine += V210_BLOCK_SIZE;
+            }
+
+            src += srcStride;
+            for (size_t p = 0; p < dsts.size(); ++p) {
+                dsts[p] += dstStrides[p];
+            }
+        }
+    }
+
+    /*
+     * Gather the samples of each 10-bit position in the 32-bit words with PSHUFB, zero-extended to 32-bit, then shift and OR them together.
+     * Samples are clamped to 10 bits. Like UnpackV210(), the loads read past the samples of the block, thus the blocks near the end of the row are packed one sample at a time.
+     * The last partial block of the row is zero-padded.
+     */
+    template <int intrinsicType>
+    static constexpr auto PackV210(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int width, int height) -> void {
+        const auto PackM128 = [](const __m128i &yVec, const __m128i &uvVec) -> __m128i {
+            const __m128i vec1 = _mm_or_si128(_mm_shuffle_epi8(yVec, _V210_PACK_Y_MASK_1), _mm_shuffle_epi8(uvVec, _V210_PACK_UV_MASK_1));
+            const __m128i vec2 = _mm_or_si128(_mm_shuffle_epi8(yVec, _V210_PACK_Y_MASK_2), _mm_shuffle_epi8(uvVec, _V210_PACK_UV_MASK_2));
+            const __m128i vec3 = _mm_or_si128(_mm_shuffle_epi8(yVec, _V210_PACK_Y_MASK_3), _mm_shuffle_epi8(uvVec, _V210_PACK_UV_MASK_3));
+            return _mm_or_si128(_mm_or_si128(vec1, _mm_slli_epi32(vec2, 10)), _mm_slli_epi32(vec3, 20));
+        };
+
+        const int numBlocks = DivideRoundUp(width, V210_BLOCK_PIXELS);
+        const int numSimdBlocks = intrinsicType >= 1 ? std::max(width - 2, 0) / V210_BLOCK_PIXELS : 0;
+        const int numDoubleBlocks = intrinsicType == 2 ? std::max(width - 4, 0) / (V210_BLOCK_PIXELS * 2) : 0;
+
+        for (int y = 0; y < height; ++y) {
+            std::array<const BYTE *, 3> srcsLine = srcs;
+            BYTE *dstLine = dst;
+            int block = 0;
+
+            if constexpr (intrinsicType == 2) {
+                const __m256i sampleMax = _mm256_set1_epi16(1023);
+                const __m256i yMask1 = _mm256_broadcastsi128_si256(_V210_PACK_Y_MASK_1);
+                const __m256i yMask2 = _mm256_broadcastsi128_si256(_V210_PACK_Y_MASK_2);
+                const __m256i yMask3 = _mm256_broadcastsi128_si256(_V210_PACK_Y_MASK_3);
+                const __m256i uvMask1 = _mm256_broadcastsi128_si256(_V210_PACK_UV_MASK_1);
+                const __m256i uvMask2 = _mm256_broadcastsi128_si256(_V210_PACK_UV_MASK_2);
+                const __m256i uvMask3 = _mm256_broadcastsi128_si256(_V210_PACK_UV_MASK_3);
+
+                for (; block < numDoubleBlocks * 2; block += 2) {
+                    const __m128i *ySrc = reinterpret_cast<const __m128i *>(srcsLine[0]);
+                    const __m128i *uSrc = reinterpret_cast<const __m128i *>(srcsLine[1]);
+                    const __m128i *vSrc = reinterpret_cast<const __m128i *>(srcsLine[2]);
+                    const __m256i yVec = _mm256_min_epu16(_mm256_loadu2_m128i(reinterpret_cast<const __m128i *>(srcsLine[0] + V210_BLOCK_PIXELS * sizeof(uint16_t)), ySrc), sampleMax);
+                    const __m128i uvVecLo = _mm_unpacklo_epi64(_mm_loadl_epi64(uSrc), _mm_loadl_epi64(vSrc));
+                    const __m128i uvVecHi = _mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[1] + V210_BLOCK_PIXELS)), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[2] + V210_BLOCK_PIXELS)));
+                    const __m256i uvVec = _mm256_min_epu16(_mm256_set_m128i(uvVecHi, uvVecLo), sampleMax);
+
+                    const __m256i vec1 = _mm256_or_si256(_mm256_shuffle_epi8(yVec, yMask1), _mm256_shuffle_epi8(uvVec, uvMask1));
+                    const __m256i vec2 = _mm256_or_si256(_mm256_shuffle_epi8(yVec, yMask2), _mm256_shuffle_epi8(uvVec, uvMask2));
+                    const __m256i vec3 = _mm256_or_si256(_mm256_shuffle_epi8(yVec, yMask3), _mm256_shuffle_epi8(uvVec, uvMask3));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i *>(dstLine), _mm256_or_si256(_mm256_or_si256(vec1, _mm256_slli_epi32(vec2, 10)), _mm256_slli_epi32(vec3, 20)));
+
+                    srcsLine[0] += V210_BLOCK_PIXELS * 2 * sizeof(uint16_t);
+                    srcsLine[1] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+                    srcsLine[2] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+                    dstLine += V210_BLOCK_SIZE * 2;
+                }
+            }
+
+            if constexpr (intrinsicType >= 1) {
+                const __m128i sampleMax = _mm_set1_epi16(1023);
+
+                for (; block < numSimdBlocks; ++block) {
+                    const __m128i yVec = _mm_min_epu16(_mm_loadu_si128(reinterpret_cast<const __m128i *>(srcsLine[0])), sampleMax);
+                    const __m128i uvVec = _mm_min_epu16(_mm_unpacklo_epi64(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[1])), _mm_loadl_epi64(reinterpret_cast<const __m128i *>(srcsLine[2]))), sampleMax);
+                    _mm_storeu_si128(reinterpret_cast<__m128i *>(dstLine), PackM128(yVec, uvVec));
+
+                    srcsLine[0] += V210_BLOCK_PIXELS * sizeof(uint16_t);
+                    srcsLine[1] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+                    srcsLine[2] += V210_BLOCK_PIXELS / 2 * sizeof(uint16_t);
+                    dstLine += V210_BLOCK_SIZE;
+                }
+            }
+
+            for (; block < numBlocks; ++block) {
+                PackV210Block(srcsLine, dstLine, std::min(width - block * V210_BLOCK_PIXELS, V210_BLOCK_PIXELS));
+                dstLine += V210_BLOCK_SIZE;
+            }
+
+            for (size_t p = 0; p < srcs.size(); ++p) {
+                srcs[p] += srcStrides[p];
+            }
+            dst += dstStride;
+        }
+    }
+
+    static std::array<KernelTable, INTRINSIC_TYPE_NAMES.size()> _kernelTables;
+    static thread_local std::vector<BYTE> _bounceBuffer;
+    static thread_local std::vector<BYTE> _chromaRowBuffer;
+    static inline std::unique_ptr<WorkerPool> _workerPool;
+};
 
-    static inline int _vectorSize;
+/*
+ * The kernels of one tier, which InitializeKernels() fills once for every supported tier.
+ * Each VideoFormat dispatches through the table of its own tier, so the tier picked for one stream never affects the others.
+ */
+struct Format::KernelTable {
+    decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVC1Func;
+    decltype(Deinterleave<0, 2, 2, 2, 1>) *deinterleaveUVC2Func;
+    decltype(Deinterleave<0, 2, 2, 2, 1, 6>) *deinterleaveUVC2ShiftFunc;
+    decltype(Deinterleave<0, 2, 4, 3, 1>) *deinterleaveY416Func;
+    decltype(Deinterleave<0, 1, 4, 3, 2>) *deinterleaveRGBC1Func;
+    decltype(DeinterleaveRGB<0, 1>) *deinterleaveRGB24Func;
+    decltype(DeinterleaveRGB<0, 2>) *deinterleaveRGB48Func;
+    decltype(DeinterleaveY410<0>) *deinterleaveY410Func;
+    decltype(InterleaveUV<0, 1>) *interleaveUVC1Func;
+    decltype(InterleaveUV<0, 2>) *interleaveUVC2Func;
+    decltype(InterleaveUV<0, 2, 6>) *interleaveUVC2ShiftFunc;
+    decltype(InterleaveUV<0, 2, 6, true>) *interleaveUVC2ShiftStreamFunc;
+    decltype(InterleaveThree<0, 1>) *interleaveY416Func;
+    decltype(InterleaveThree<0, 2>) *interleaveRGBC1Func;
+    decltype(InterleaveRGB<0, 1>) *interleaveRGB24Func;
+    decltype(InterleaveRGB<0, 2>) *interleaveRGB48Func;
+    decltype(SwapRedBlue<0, 3>) *swapRedBlue48Func;
+    decltype(SwapRedBlue<0, 4>) *swapRedBlue64Func;
+    decltype(InterleaveY410<0>) *interleaveY410Func;
+    decltype(DeinterleaveYUYV<0, 2, 6>) *deinterleaveY210Func;
+    decltype(DeinterleaveYUYV<0, 2>) *deinterleaveY216Func;
+    decltype(InterleaveYUYV<0, 2, 6>) *interleaveY210Func;
+    decltype(InterleaveYUYV<0, 2>) *interleaveY216Func;
+    decltype(DeinterleaveYUYV<0, 1>) *deinterleaveYUY2Func;
+    decltype(DeinterleaveYUYV<0, 1, 0, true>) *deinterleaveUYVYFunc;
+    decltype(InterleaveYUYV<0, 1>) *interleaveYUY2Func;
+    decltype(InterleaveYUYV<0, 1, 0, true>) *interleaveUYVYFunc;
+    decltype(UnpackV210<0>) *unpackV210Func;
+    decltype(PackV210<0>) *packV210Func;
+    decltype(ReduceBitDepth<0, 8>) *reduceBitDepthC1Func;
+    decltype(ReduceBitDepth<0, 10>) *reduceBitDepthC2Func;
+    decltype(InterleaveUVReduceBitDepth<0, 8>) *interleaveUVReduceC1Func;
+    decltype(InterleaveUVReduceBitDepth<0, 10>) *interleaveUVReduceC2Func;
+    decltype(ConvertYUVToRGB32<0, 1>) *yuvToRGB32Func;
+    decltype(ConvertYUVToRGB32<0, 2>) *yuvToRGB32SubsampledFunc;
+    decltype(AverageRows<0, 1>) *averageRowsC1Func;
+    decltype(AverageRows<0, 2>) *averageRowsC2Func;
+    decltype(InterleaveUVResample<0, 1, true>) *uvDownsampleC1Func;
+    decltype(InterleaveUVResample<0, 2, true>) *uvDownsampleC2Func;
+    decltype(InterleaveUVResample<0, 1, false>) *uvUpsampleC1Func;
+    decltype(InterleaveUVResample<0, 2, false>) *uvUpsampleC2Func;
+    decltype(BitShiftEach16BitInt<0, 6, true>) *rightShiftFunc;
+    decltype(BitShiftEach16BitInt<0, 6, false>) *leftShiftFunc;
+    decltype(BitShiftEach16BitInt<0, 6, false, true>) *leftShiftStreamFunc;
+    decltype(StreamLoadCopy<0>) *streamLoadCopyFunc;
+
+    int vectorSize;
 };
 
 }
@@ -0,0 +1,73 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "environment.h"
+#include "macros.h"
+#include "simd.h"
+#include "util.h"
+#include "worker_pool.h"
+
+// Format is included after everything else, so that only its kernels and tables are compiled for AVX2
+BEGIN_TARGET_ISA("avx2,bmi,bmi2,fma")
+#include "format.h"
+
+
+namespace SynthFilter {
+
+auto Format::InitializeAVX2(KernelTable &kernels) -> void {
+    _UV_SHUFFLE_MASK_M256_C1  = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
+    _UV_SHUFFLE_MASK_M256_C2  = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    _Y416_SHUFFLE_MASK_M256   = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
+    _RGB_SHUFFLE_MASK_M256_C1 = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+    _FOUR_PERMUTE_INDEX       = _mm256_setr_epi8(0, 0, 0, 0, 4, 0, 0, 0, 1, 0, 0, 0, 5, 0, 0, 0, 2, 0, 0, 0, 6, 0, 0, 0, 3, 0, 0, 0, 7, 0, 0, 0);
+
+    kernels.deinterleaveUVC1Func          = Deinterleave<2, 1, 2, 2, 1>;
+    kernels.deinterleaveUVC2Func          = Deinterleave<2, 2, 2, 2, 1>;
+    kernels.deinterleaveUVC2ShiftFunc     = Deinterleave<2, 2, 2, 2, 1, 6>;
+    kernels.deinterleaveY416Func          = Deinterleave<2, 2, 4, 3, 1>;
+    kernels.deinterleaveRGBC1Func         = Deinterleave<2, 1, 4, 3, 2>;
+    kernels.deinterleaveY410Func          = DeinterleaveY410<2>;
+    kernels.deinterleaveRGB24Func         = DeinterleaveRGB<2, 1>;
+    kernels.deinterleaveRGB48Func         = DeinterleaveRGB<2, 2>;
+    kernels.interleaveUVC1Func            = InterleaveUV<2, 1>;
+    kernels.interleaveUVC2Func            = InterleaveUV<2, 2>;
+    kernels.interleaveUVC2ShiftFunc       = InterleaveUV<2, 2, 6>;
+    kernels.interleaveUVC2ShiftStreamFunc = InterleaveUV<2, 2, 6, true>;
+    kernels.interleaveY416Func            = InterleaveThree<2, 1>;
+    kernels.interleaveRGBC1Func           = InterleaveThree<2, 2>;
+    kernels.interleaveY410Func            = InterleaveY410<2>;
+    kernels.deinterleaveY210Func          = DeinterleaveYUYV<2, 2, 6>;
+    kernels.deinterleaveY216Func          = DeinterleaveYUYV<2, 2>;
+    kernels.interleaveY210Func            = InterleaveYUYV<2, 2, 6>;
+    kernels.interleaveY216Func            = InterleaveYUYV<2, 2>;
+    kernels.deinterleaveYUY2Func          = DeinterleaveYUYV<2, 1>;
+    kernels.deinterleaveUYVYFunc          = DeinterleaveYUYV<2, 1, 0, true>;
+    kernels.interleaveYUY2Func            = InterleaveYUYV<2, 1>;
+    kernels.interleaveUYVYFunc            = InterleaveYUYV<2, 1, 0, true>;
+    kernels.unpackV210Func                = UnpackV210<2>;
+    kernels.packV210Func                  = PackV210<2>;
+    kernels.interleaveRGB24Func           = InterleaveRGB<2, 1>;
+    kernels.interleaveRGB48Func           = InterleaveRGB<2, 2>;
+    kernels.swapRedBlue48Func             = SwapRedBlue<2, 3>;
+    kernels.swapRedBlue64Func             = SwapRedBlue<2, 4>;
+    kernels.reduceBitDepthC1Func          = ReduceBitDepth<2, 8>;
+    kernels.reduceBitDepthC2Func          = ReduceBitDepth<2, 10>;
+    kernels.interleaveUVReduceC1Func      = InterleaveUVReduceBitDepth<2, 8>;
+    kernels.interleaveUVReduceC2Func      = InterleaveUVReduceBitDepth<2, 10>;
+    kernels.yuvToRGB32Func                = ConvertYUVToRGB32<2, 1>;
+    kernels.yuvToRGB32SubsampledFunc      = ConvertYUVToRGB32<2, 2>;
+    kernels.averageRowsC1Func             = AverageRows<2, 1>;
+    kernels.averageRowsC2Func             = AverageRows<2, 2>;
+    kernels.uvDownsampleC1Func            = InterleaveUVResample<2, 1, true>;
+    kernels.uvDownsampleC2Func            = InterleaveUVResample<2, 2, true>;
+    kernels.uvUpsampleC1Func              = InterleaveUVResample<2, 1, false>;
+    kernels.uvUpsampleC2Func              = InterleaveUVResample<2, 2, false>;
+    kernels.rightShiftFunc                = BitShiftEach16BitInt<2, 6, true>;
+    kernels.leftShiftFunc                 = BitShiftEach16BitInt<2, 6, false>;
+    kernels.leftShiftStreamFunc           = BitShiftEach16BitInt<2, 6, false, true>;
+    kernels.streamLoadCopyFunc            = StreamLoadCopy<2>;
+    kernels.vectorSize                    = sizeof(__m256i);
+}
+
+}
+
+END_TARGET_ISA
@@ -0,0 +1,48 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "environment.h"
+#include "macros.h"
+#include "simd.h"
+#include "util.h"
+#include "worker_pool.h"
+
+// the AVX-512 F, DQ, CD, BW, VL and VBMI that Environment::IsSupportAVX512() checks, on top of the AVX2 set
+BEGIN_TARGET_ISA("avx2,bmi,bmi2,fma,avx512f,avx512dq,avx512cd,avx512bw,avx512vl,avx512vbmi")
+#include "format.h"
+
+
+namespace SynthFilter {
+
+auto Format::InitializeAVX512(KernelTable &kernels) -> void {
+    _UV_PERMUTE_INDEX_M512_C1       = _mm512_loadu_si512(GeneratePermuteIndex<uint8_t, 64, 2>().data());
+    _UV_PERMUTE_INDEX_M512_C2       = _mm512_loadu_si512(GeneratePermuteIndex<uint16_t, 32, 2>().data());
+    _Y416_PERMUTE_INDEX_M512        = _mm512_loadu_si512(GeneratePermuteIndex<uint16_t, 32, 4>().data());
+    _RGB_PERMUTE_INDEX_M512_C1      = _mm512_loadu_si512(GeneratePermuteIndex<uint8_t, 64, 4>().data());
+    _UV_INTERLEAVE_INDEX_M512_C1_LO = _mm512_loadu_si512(GenerateInterleaveIndex<uint8_t, 64, 0>().data());
+    _UV_INTERLEAVE_INDEX_M512_C1_HI = _mm512_loadu_si512(GenerateInterleaveIndex<uint8_t, 64, 1>().data());
+    _UV_INTERLEAVE_INDEX_M512_C2_LO = _mm512_loadu_si512(GenerateInterleaveIndex<uint16_t, 32, 0>().data());
+    _UV_INTERLEAVE_INDEX_M512_C2_HI = _mm512_loadu_si512(GenerateInterleaveIndex<uint16_t, 32, 1>().data());
+    _QWORD_INDEX_M512               = _mm512_setr_epi64(0, 1, 2, 3, 4, 5, 6, 7);
+
+    kernels.deinterleaveUVC1Func          = Deinterleave<3, 1, 2, 2, 1>;
+    kernels.deinterleaveUVC2Func          = Deinterleave<3, 2, 2, 2, 1>;
+    kernels.deinterleaveUVC2ShiftFunc     = Deinterleave<3, 2, 2, 2, 1, 6>;
+    kernels.deinterleaveY416Func          = Deinterleave<3, 2, 4, 3, 1>;
+    kernels.deinterleaveRGBC1Func         = Deinterleave<3, 1, 4, 3, 2>;
+    kernels.deinterleaveY410Func          = DeinterleaveY410<3>;
+    kernels.interleaveUVC1Func            = InterleaveUV<3, 1>;
+    kernels.interleaveUVC2Func            = InterleaveUV<3, 2>;
+    kernels.interleaveUVC2ShiftFunc       = InterleaveUV<3, 2, 6>;
+    kernels.interleaveUVC2ShiftStreamFunc = InterleaveUV<3, 2, 6, true>;
+    kernels.interleaveY410Func            = InterleaveY410<3>;
+    kernels.swapRedBlue64Func             = SwapRedBlue<3, 4>;
+    kernels.rightShiftFunc                = BitShiftEach16BitInt<3, 6, true>;
+    kernels.leftShiftFunc                 = BitShiftEach16BitInt<3, 6, false>;
+    kernels.leftShiftStreamFunc           = BitShiftEach16BitInt<3, 6, false, true>;
+    kernels.streamLoadCopyFunc            = StreamLoadCopy<3>;
+    kernels.vectorSize                    = sizeof(__m512i);
+}
+
+}
+
+END_TARGET_ISA
@@ -0,0 +1,249 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "format.h"
+
+#include "constants.h"
+#include "environment.h"
+
+
+namespace SynthFilter {
+
+namespace {
+
+/*
+ * Every buffer of the benchmark is aligned to the largest vector size, and each row is padded by one more vector,
+ * so that the kernels of all tiers are free to read and write past the row size like on the padded media samples.
+ */
+constexpr const int BENCHMARK_BUFFER_ALIGNMENT = 64;
+
+auto ReadTimestampCounter() -> uint64_t {
+    return __rdtsc();
+}
+
+}
+
+auto Format::GetBenchmarkStride(int rowSize) -> int {
+    return (DivideRoundUp(rowSize, BENCHMARK_BUFFER_ALIGNMENT) + 1) * BENCHMARK_BUFFER_ALIGNMENT;
+}
+
+auto Format::AllocateBenchmarkBuffer(std::vector<BYTE> &storage, size_t size) -> BYTE * {
+    storage.assign(size + BENCHMARK_BUFFER_ALIGNMENT, 0);
+    return storage.data() + (BENCHMARK_BUFFER_ALIGNMENT - reinterpret_cast<uintptr_t>(storage.data()) % BENCHMARK_BUFFER_ALIGNMENT) % BENCHMARK_BUFFER_ALIGNMENT;
+}
+
+auto Format::MeasureRuns(const std::function<void()> &run) -> BenchmarkStats {
+    // the warm-up run also faults in the pages of the buffers
+    run();
+
+    std::array<double, BENCHMARK_ITERATIONS> durations;
+    const uint64_t startTicks = ReadTimestampCounter();
+    for (double &duration : durations) {
+        const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        run();
+        duration = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - startTime).count();
+    }
+    const uint64_t totalTicks = ReadTimestampCounter() - startTicks;
+
+    const double mean = std::accumulate(durations.begin(), durations.end(), 0.0) / durations.size();
+    const double variance = std::accumulate(durations.begin(), durations.end(), 0.0, [mean](double sum, double duration) -> double {
+        return sum + (duration - mean) * (duration - mean);
+    }) / durations.size();
+
+    return { .meanMicroseconds = mean, .stdDevMicroseconds = std::sqrt(variance), .ticksPerRun = static_cast<double>(totalTicks) / durations.size() };
+}
+
+auto Format::IsFrameCopySupported(const VideoFormat &videoFormat) -> bool {
+    return videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED || videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE;
+}
+
+auto Format::AllocateFrameCopyBuffers(const VideoFormat &videoFormat, std::vector<BYTE> &sampleStorage, std::array<std::vector<BYTE>, 3> &planeStorages) -> FrameCopyBuffers {
+    const int width = videoFormat.videoInfo.width;
+    const int height = videoFormat.videoInfo.height;
+    // biBitCount counts the main plane and both subsampled planes
+    const int subsampleArea = videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio;
+    const int componentSize = videoFormat.pixelFormat->bitCount * subsampleArea / ((subsampleArea + 2) * 8);
+
+    const std::array frameStrides {
+        GetBenchmarkStride(width * componentSize),
+        GetBenchmarkStride(width / videoFormat.pixelFormat->subsampleWidthRatio * componentSize),
+        GetBenchmarkStride(width / videoFormat.pixelFormat->subsampleWidthRatio * componentSize),
+    };
+    std::array<BYTE *, 3> frameSlices {};
+    for (size_t p = 0; p < frameSlices.size(); ++p) {
+        frameSlices[p] = AllocateBenchmarkBuffer(planeStorages[p], static_cast<size_t>(frameStrides[p]) * (height + 1));
+    }
+
+    return {
+        // the media sample packs all planes contiguously without padding, only its end needs the room for the kernels to overrun
+        .sample = AllocateBenchmarkBuffer(sampleStorage, GetBitmapImageSize(videoFormat.bmi) + static_cast<size_t>(BENCHMARK_BUFFER_ALIGNMENT) * 2),
+        .frameSlices = frameSlices,
+        .frameStrides = frameStrides,
+#ifdef AVSF_AVISYNTH
+        // AviSynth+ passes the row size of the main plane in bytes as the frame width
+        .frameWidth = width * componentSize,
+#else
+        .frameWidth = width,
+#endif
+        .height = height,
+    };
+}
+
+auto Format::MeasureCopyFromInput(const VideoFormat &videoFormat, const FrameCopyBuffers &buffers) -> BenchmarkStats {
+    return MeasureRuns([&]() -> void {
+        CopyFromInput(videoFormat, buffers.sample, buffers.frameSlices, buffers.frameStrides, buffers.frameWidth, buffers.height);
+    });
+}
+
+auto Format::MeasureCopyToOutput(const VideoFormat &videoFormat, const FrameCopyBuffers &buffers) -> BenchmarkStats {
+    return MeasureRuns([&]() -> void {
+        CopyToOutput(videoFormat, { buffers.frameSlices[0], buffers.frameSlices[1], buffers.frameSlices[2] }, buffers.frameStrides, buffers.sample, buffers.frameWidth, buffers.height, videoFormat.videoInfo);
+    });
+}
+
+/**
+ * Pick the tier and the stripe sizes for the conversions between the input and output media types, either from the plan saved by an earlier run,
+ * or by timing CopyFromInput() and CopyToOutput() of the whole frame with every candidate. The caller applies the plan with ApplyKernelPlan().
+ *
+ * The tiers are compared on the total time of both directions, while the stripe size of each direction is picked on its own.
+ * Every candidate runs through the kernel table of its tier, thus the conversions of the other streams are never affected.
+ * Formats whose tuning would take longer than AUTOTUNE_TIME_BUDGET are left untuned, and no plan is saved for them.
+ */
+auto Format::AutotuneKernels(const AM_MEDIA_TYPE &inputMediaType, const AM_MEDIA_TYPE &outputMediaType, const FrameServerBase *frameServerInstance) -> std::optional<KernelPlan> {
+    const int supportedIntrinsicType = GetSupportedIntrinsicType();
+    VideoFormat inputVideoFormat = GetVideoFormat(inputMediaType, frameServerInstance);
+    VideoFormat outputVideoFormat = GetVideoFormat(outputMediaType, frameServerInstance);
+    const std::wstring planName = std::format(L"{}_{}x{}_{}_{}x{}",
+                                              inputVideoFormat.pixelFormat->name, inputVideoFormat.videoInfo.width, inputVideoFormat.videoInfo.height,
+                                              outputVideoFormat.pixelFormat->name, outputVideoFormat.videoInfo.width, outputVideoFormat.videoInfo.height);
+
+    if (!IsFrameCopySupported(inputVideoFormat) || !IsFrameCopySupported(outputVideoFormat)) {
+        Environment::GetInstance().Log(L"Kernel autotuning only supports the planar and semi-planar formats, skipping %ls", planName.c_str());
+        return std::nullopt;
+    }
+
+    // the saved plan is the name of the tier followed by the stripe sizes of both directions, such as "AVX2,64,-1"
+    std::optional<KernelPlan> optPlan;
+    if (const std::wstring savedPlan = Environment::GetInstance().GetKernelPlan(planName); !savedPlan.empty()) {
+        if (std::wsmatch planMatch; std::regex_match(savedPlan, planMatch, std::wregex(L"([^,]+),(-?\\d{1,9}),(-?\\d{1,9})"))) {
+            // plans from a different CPU may name a tier that is not supported here
+            const std::string tierName = ConvertWideToUtf8(planMatch[1].str());
+            for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+                if (tierName == INTRINSIC_TYPE_NAMES[intrinsicType]) {
+                    optPlan = KernelPlan { .intrinsicType = intrinsicType, .inputStripeSize = std::stoi(planMatch[2].str()), .outputStripeSize = std::stoi(planMatch[3].str()) };
+                    Environment::GetInstance().Log(L"Load kernel plan for %ls: %ls", planName.c_str(), savedPlan.c_str());
+                    break;
+                }
+            }
+        }
+    }
+
+    if (!optPlan) {
+        Environment::GetInstance().Log(L"Start kernel autotuning for %ls", planName.c_str());
+
+        const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+        const auto IsOverBudget = [&startTime]() -> bool {
+            return std::chrono::steady_clock::now() - startTime > AUTOTUNE_TIME_BUDGET;
+        };
+
+        KernelPlan bestPlan {};
+        double bestMicroseconds = std::numeric_limits<double>::max();
+
+        // the candidates are timed one direction at a time, and the stripe size with the lowest mean wins for the direction
+        const auto PickStripeSize = [&IsOverBudget](VideoFormat &videoFormat, const std::function<BenchmarkStats(const VideoFormat &)> &measure) -> std::optional<std::pair<int, double>> {
+            std::pair<int, double> ret { 0, std::numeric_limits<double>::max() };
+
+            for (const int stripeSize : AUTOTUNE_STRIPE_SIZES) {
+                if (IsOverBudget()) {
+                    return std::nullopt;
+                }
+
+                videoFormat.tunedStripeSize = stripeSize;
+                if (const double meanMicroseconds = measure(videoFormat).meanMicroseconds; meanMicroseconds < ret.second) {
+                    ret = { stripeSize, meanMicroseconds };
+                }
+            }
+
+            return ret;
+        };
+
+        try {
+            std::vector<BYTE> sampleStorage;
+            std::array<std::vector<BYTE>, 3> planeStorages;
+
+            {
+                // every candidate copies the frame once to warm up and BENCHMARK_ITERATIONS times to measure
+                const auto TimeOnce = [](const std::function<void()> &run) -> std::chrono::steady_clock::duration {
+                    const std::chrono::steady_clock::time_point runStartTime = std::chrono::steady_clock::now();
+                    run();
+                    return std::chrono::steady_clock::now() - runStartTime;
+                };
+
+                inputVideoFormat.kernels = &_kernelTables[supportedIntrinsicType];
+                outputVideoFormat.kernels = &_kernelTables[supportedIntrinsicType];
+
+                const FrameCopyBuffers inputBuffers = AllocateFrameCopyBuffers(inputVideoFormat, sampleStorage, planeStorages);
+                std::chrono::steady_clock::duration roundTripTime = TimeOnce([&]() -> void {
+                    CopyFromInput(inputVideoFormat, inputBuffers.sample, inputBuffers.frameSlices, inputBuffers.frameStrides, inputBuffers.frameWidth, inputBuffers.height);
+                });
+                const FrameCopyBuffers outputBuffers = AllocateFrameCopyBuffers(outputVideoFormat, sampleStorage, planeStorages);
+                roundTripTime += TimeOnce([&]() -> void {
+                    CopyToOutput(outputVideoFormat, { outputBuffers.frameSlices[0], outputBuffers.frameSlices[1], outputBuffers.frameSlices[2] }, outputBuffers.frameStrides, outputBuffers.sample, outputBuffers.frameWidth, outputBuffers.height, outputVideoFormat.videoInfo);
+                });
+
+                const std::chrono::steady_clock::duration estimatedTime = roundTripTime * (supportedIntrinsicType + 1) * static_cast<int>(AUTOTUNE_STRIPE_SIZES.size()) * (BENCHMARK_ITERATIONS + 1);
+                if (estimatedTime > AUTOTUNE_TIME_BUDGET) {
+                    Environment::GetInstance().Log(L"Kernel autotuning for %ls would take at least %lld ms, over the budget of %lld ms, skipping",
+                                                   planName.c_str(), std::chrono::duration_cast<std::chrono::milliseconds>(estimatedTime).count(), AUTOTUNE_TIME_BUDGET.count());
+                    return std::nullopt;
+                }
+            }
+
+            for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+                inputVideoFormat.kernels = &_kernelTables[intrinsicType];
+                outputVideoFormat.kernels = &_kernelTables[intrinsicType];
+
+                const FrameCopyBuffers inputBuffers = AllocateFrameCopyBuffers(inputVideoFormat, sampleStorage, planeStorages);
+                const std::optional<std::pair<int, double>> optInputResult = PickStripeSize(inputVideoFormat, [&inputBuffers](const VideoFormat &videoFormat) -> BenchmarkStats {
+                    return MeasureCopyFromInput(videoFormat, inputBuffers);
+                });
+
+                std::optional<std::pair<int, double>> optOutputResult;
+                if (optInputResult) {
+                    const FrameCopyBuffers outputBuffers = AllocateFrameCopyBuffers(outputVideoFormat, sampleStorage, planeStorages);
+                    optOutputResult = PickStripeSize(outputVideoFormat, [&outputBuffers](const VideoFormat &videoFormat) -> BenchmarkStats {
+                        return MeasureCopyToOutput(videoFormat, outputBuffers);
+                    });
+                }
+
+                if (!optOutputResult) {
+                    Environment::GetInstance().Log(L"Kernel autotuning for %ls runs past the budget of %lld ms, aborting", planName.c_str(), AUTOTUNE_TIME_BUDGET.count());
+                    return std::nullopt;
+                }
+
+                const auto [inputStripeSize, inputMicroseconds] = *optInputResult;
+                const auto [outputStripeSize, outputMicroseconds] = *optOutputResult;
+                Environment::GetInstance().Log(L"Kernel autotuning %hs: input stripe size %d %.1f us, output stripe size %d %.1f us",
+                                               INTRINSIC_TYPE_NAMES[intrinsicType], inputStripeSize, inputMicroseconds, outputStripeSize, outputMicroseconds);
+
+                if (inputMicroseconds + outputMicroseconds < bestMicroseconds) {
+                    bestPlan = { .intrinsicType = intrinsicType, .inputStripeSize = inputStripeSize, .outputStripeSize = outputStripeSize };
+                    bestMicroseconds = inputMicroseconds + outputMicroseconds;
+                }
+            }
+        } catch (const std::bad_alloc &) {
+            // the frames of large resolutions may not fit in the address space of the 32-bit build
+            Environment::GetInstance().Log(L"Kernel autotuning is aborted due to insufficient memory");
+            return std::nullopt;
+        }
+
+        optPlan = bestPlan;
+        Environment::GetInstance().SetKernelPlan(planName, std::format(L"{},{},{}", ConvertUtf8ToWide(INTRINSIC_TYPE_NAMES[bestPlan.intrinsicType]), bestPlan.inputStripeSize, bestPlan.outputStripeSize));
+    }
+
+    Environment::GetInstance().Log(L"Kernel plan for %ls: tier %hs input stripe size %d output stripe size %d",
+                                   planName.c_str(), INTRINSIC_TYPE_NAMES[optPlan->intrinsicType], optPlan->inputStripeSize, optPlan->outputStripeSize);
+
+    return optPlan;
+}
+
+}
@@ -1,5 +1,6 @@
 // License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
 
+#include "constants.h"
 #include "environment.h"
 #include "format.h"
 #include "macros.h"
@@ -7,6 +8,11 @@
 
 namespace SynthFilter {
 
+// defined here rather than inline in the header, so that their initialization is never compiled for the SIMD tiers
+thread_local std::vector<BYTE> Format::_bounceBuffer;
+thread_local std::vector<BYTE> Format::_chromaRowBuffer;
+std::array<Format::KernelTable, Format::INTRINSIC_TYPE_NAMES.size()> Format::_kernelTables;
+
 auto Format::VideoFormat::ColorSpaceInfo::Update(const DXVA_ExtendedFormat &dxvaExtFormat) -> void {
     switch (dxvaExtFormat.NominalRange) {
     case DXVA_NominalRange_Normal:
@@ -49,6 +55,10 @@ auto Format::VideoFormat::ColorSpaceInfo::Update(const DXVA_ExtendedFormat &dxva
     case DXVA_VideoTransferMatrix_SMPTE240M:
         matrix = VSMatrixCoefficients::VSC_MATRIX_ST240_M;
         break;
+    case DXVA_VIDEO_TRANSFER_MATRIX_BT2020_10:
+    case DXVA_VIDEO_TRANSFER_MATRIX_BT2020_12:
+        matrix = VSMatrixCoefficients::VSC_MATRIX_BT2020_NCL;
+        break;
     }
 
     switch (dxvaExtFormat.VideoTransferFunction) {
@@ -74,50 +84,152 @@ auto Format::VideoFormat::GetCodecFourCC() const -> DWORD {
     return FOURCCMap(&pixelFormat->mediaSubtype).GetFOURCC();
 }
 
+/*
+ * The frame dimension comes from rcSource, and the sample buffer may be larger. Empty rectangles refer to the whole buffer.
+ */
+auto Format::VideoFormat::UpdateVisibleRegion(const VIDEOINFOHEADER &vih) -> void {
+    if (IsRectEmpty(&vih.rcSource)) {
+        videoInfo.width = bmi.biWidth;
+        videoInfo.height = abs(bmi.biHeight);
+    } else {
+        videoInfo.width = vih.rcSource.right - vih.rcSource.left;
+        videoInfo.height = vih.rcSource.bottom - vih.rcSource.top;
+        sourceLeft = vih.rcSource.left;
+        sourceTop = vih.rcSource.top;
+    }
+
+    if (!IsRectEmpty(&vih.rcTarget)) {
+        targetLeft = vih.rcTarget.left;
+        targetTop = vih.rcTarget.top;
+    }
+}
+
 auto Format::Initialize() -> void {
+    // planes of the packed RGB kernels are in the order of the components in memory
+    _RGB24_DEINTERLEAVE_MASKS = GenerateBlockShuffleMasks([](int dstByte) -> int {
+        return dstByte % 16 * 3 + dstByte / 16;
+    });
+    _RGB24_INTERLEAVE_MASKS = GenerateBlockShuffleMasks([](int dstByte) -> int {
+        return dstByte % 3 * 16 + dstByte / 3;
+    });
+    _RGB48_DEINTERLEAVE_MASKS = GenerateBlockShuffleMasks([](int dstByte) -> int {
+        return (dstByte % 16 / 2 * 3 + dstByte / 16) * 2 + dstByte % 2;
+    });
+    _RGB48_INTERLEAVE_MASKS = GenerateBlockShuffleMasks([](int dstByte) -> int {
+        return dstByte / 2 % 3 * 16 + dstByte / 6 * 2 + dstByte % 2;
+    });
+    _RGB48_SWAP_MASKS = GenerateBlockShuffleMasks([](int dstByte) -> int {
+        return dstByte / 6 * 6 + (2 - dstByte % 6 / 2) * 2 + dstByte % 2;
+    });
+
+    // the lower tiers stay available for the kernel autotuning, and the media samples are aligned for the highest one, which also suits the others
+    const int supportedIntrinsicType = GetSupportedIntrinsicType();
+    for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+        InitializeKernels(intrinsicType);
+    }
+
+    if (const int vectorSize = _kernelTables[supportedIntrinsicType].vectorSize; vectorSize == sizeof(__m512i)) {
+        // the AVX-512 kernels handle row tails with masked loads and stores, so one vector of alignment is enough for both sides
+        INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = vectorSize;
+        OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = vectorSize;
+    } else {
+        INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = vectorSize == 0 ? 8 : vectorSize;
+        OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = (vectorSize == 0 ? 2 : vectorSize) * 2;
+    }
+
+    // the calling thread of each conversion also works on its own row ranges, thus one less worker than the physical cores
+    if (Environment::GetInstance().IsParallelConversionEnabled() && Environment::GetInstance().GetNumPhysicalCores() > 1) {
+        _workerPool = std::make_unique<WorkerPool>(Environment::GetInstance().GetNumPhysicalCores() - 1);
+    }
+}
+
+auto Format::GetSupportedIntrinsicType() -> int {
+    if (Environment::GetInstance().IsSupportAVX512()) {
+        return 3;
+    }
     if (Environment::GetInstance().IsSupportAVX2()) {
-        _UV_SHUFFLE_MASK_M256_C1  = _mm256_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15, 0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
-        _UV_SHUFFLE_MASK_M256_C2  = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15, 0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
-        _Y416_SHUFFLE_MASK_M256   = _mm256_setr_epi8(0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15, 0, 1, 8, 9, 2, 3, 10, 11, 4, 5, 12, 13, 6, 7, 14, 15);
-        _RGB_SHUFFLE_MASK_M256_C1 = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15, 0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
-        _FOUR_PERMUTE_INDEX       = _mm256_setr_epi8(0, 0, 0, 0, 4, 0, 0, 0, 1, 0, 0, 0, 5, 0, 0, 0, 2, 0, 0, 0, 6, 0, 0, 0, 3, 0, 0, 0, 7, 0, 0, 0);
-
-        _deinterleaveUVC1Func  = Deinterleave<2, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<2, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<2, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<2, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<2, 1>;
-        _interleaveUVC2Func    = InterleaveUV<2, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<2, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<2, 6, false>;
-        _vectorSize            = sizeof(__m256i);
-    } else if (Environment::GetInstance().IsSupportSSE4()) {
-        _deinterleaveUVC1Func  = Deinterleave<1, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<1, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<1, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<1, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<1, 1>;
-        _interleaveUVC2Func    = InterleaveUV<1, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<1, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<1, 6, false>;
-        _vectorSize            = sizeof(__m128i);
+        return 2;
+    }
+    if (Environment::GetInstance().IsSupportSSE4()) {
+        return 1;
+    }
+    return 0;
+}
+
+auto Format::InitializeKernels(int intrinsicType) -> void {
+    KernelTable &kernels = _kernelTables[intrinsicType];
+
+    // each tier is compiled in its own translation unit for its instruction set
+    // the AVX-512 tier builds on top of the AVX2 one, which covers the kernels that have no AVX-512 version
+    if (intrinsicType == 3) {
+        InitializeAVX2(kernels);
+        InitializeAVX512(kernels);
+    } else if (intrinsicType == 2) {
+        InitializeAVX2(kernels);
+    } else if (intrinsicType == 1) {
+        InitializeSSE4(kernels);
     } else {
-        _deinterleaveUVC1Func  = Deinterleave<0, 1, 2, 2, 1>;
-        _deinterleaveUVC2Func  = Deinterleave<0, 2, 2, 2, 1>;
-        _deinterleaveY416Func  = Deinterleave<0, 2, 4, 3, 1>;
-        _deinterleaveRGBC1Func = Deinterleave<0, 1, 4, 3, 2>;
-        _interleaveUVC1Func    = InterleaveUV<0, 1>;
-        _interleaveUVC2Func    = InterleaveUV<0, 2>;
-        _rightShiftFunc        = BitShiftEach16BitInt<0, 6, true>;
-        _leftShiftFunc         = BitShiftEach16BitInt<0, 6, false>;
-        _vectorSize            = 0;
+        kernels.deinterleaveUVC1Func          = Deinterleave<0, 1, 2, 2, 1>;
+        kernels.deinterleaveUVC2Func          = Deinterleave<0, 2, 2, 2, 1>;
+        kernels.deinterleaveUVC2ShiftFunc     = Deinterleave<0, 2, 2, 2, 1, 6>;
+        kernels.deinterleaveY416Func          = Deinterleave<0, 2, 4, 3, 1>;
+        kernels.deinterleaveRGBC1Func         = Deinterleave<0, 1, 4, 3, 2>;
+        kernels.deinterleaveY410Func          = DeinterleaveY410<0>;
+        kernels.deinterleaveRGB24Func         = DeinterleaveRGB<0, 1>;
+        kernels.deinterleaveRGB48Func         = DeinterleaveRGB<0, 2>;
+        kernels.interleaveUVC1Func            = InterleaveUV<0, 1>;
+        kernels.interleaveUVC2Func            = InterleaveUV<0, 2>;
+        kernels.interleaveUVC2ShiftFunc       = InterleaveUV<0, 2, 6>;
+        kernels.interleaveUVC2ShiftStreamFunc = InterleaveUV<0, 2, 6, true>;
+        kernels.interleaveY416Func            = InterleaveThree<0, 1>;
+        kernels.interleaveRGBC1Func           = InterleaveThree<0, 2>;
+        kernels.interleaveY410Func            = InterleaveY410<0>;
+        kernels.deinterleaveY210Func          = DeinterleaveYUYV<0, 2, 6>;
+        kernels.deinterleaveY216Func          = DeinterleaveYUYV<0, 2>;
+        kernels.interleaveY210Func            = InterleaveYUYV<0, 2, 6>;
+        kernels.interleaveY216Func            = InterleaveYUYV<0, 2>;
+        kernels.deinterleaveYUY2Func          = DeinterleaveYUYV<0, 1>;
+        kernels.deinterleaveUYVYFunc          = DeinterleaveYUYV<0, 1, 0, true>;
+        kernels.interleaveYUY2Func            = InterleaveYUYV<0, 1>;
+        kernels.interleaveUYVYFunc            = InterleaveYUYV<0, 1, 0, true>;
+        kernels.unpackV210Func                = UnpackV210<0>;
+        kernels.packV210Func                  = PackV210<0>;
+        kernels.interleaveRGB24Func           = InterleaveRGB<0, 1>;
+        kernels.interleaveRGB48Func           = InterleaveRGB<0, 2>;
+        kernels.swapRedBlue48Func             = SwapRedBlue<0, 3>;
+        kernels.swapRedBlue64Func             = SwapRedBlue<0, 4>;
+        kernels.reduceBitDepthC1Func          = ReduceBitDepth<0, 8>;
+        kernels.reduceBitDepthC2Func          = ReduceBitDepth<0, 10>;
+        kernels.interleaveUVReduceC1Func      = InterleaveUVReduceBitDepth<0, 8>;
+        kernels.interleaveUVReduceC2Func      = InterleaveUVReduceBitDepth<0, 10>;
+        kernels.yuvToRGB32Func                = ConvertYUVToRGB32<0, 1>;
+        kernels.yuvToRGB32SubsampledFunc      = ConvertYUVToRGB32<0, 2>;
+        kernels.averageRowsC1Func             = AverageRows<0, 1>;
+        kernels.averageRowsC2Func             = AverageRows<0, 2>;
+        kernels.uvDownsampleC1Func            = InterleaveUVResample<0, 1, true>;
+        kernels.uvDownsampleC2Func            = InterleaveUVResample<0, 2, true>;
+        kernels.uvUpsampleC1Func              = InterleaveUVResample<0, 1, false>;
+        kernels.uvUpsampleC2Func              = InterleaveUVResample<0, 2, false>;
+        kernels.rightShiftFunc                = BitShiftEach16BitInt<0, 6, true>;
+        kernels.leftShiftFunc                 = BitShiftEach16BitInt<0, 6, false>;
+        kernels.leftShiftStreamFunc           = BitShiftEach16BitInt<0, 6, false, true>;
+        kernels.streamLoadCopyFunc            = StreamLoadCopy<0>;
+        kernels.vectorSize                    = 0;
     }
+}
 
-    _interleaveY416Func = InterleaveThree<1>;
-    _interleaveRGBC1Func = InterleaveThree<2>;
+/*
+ * The autotuned tier replaces the default one of both video formats, which have to be worked out from the same media types as the plan.
+ */
+auto Format::ApplyKernelPlan(const KernelPlan &kernelPlan, VideoFormat &inputVideoFormat, VideoFormat &outputVideoFormat) -> void {
+    inputVideoFormat.kernels = &_kernelTables[kernelPlan.intrinsicType];
+    inputVideoFormat.tunedStripeSize = kernelPlan.inputStripeSize;
+    outputVideoFormat.kernels = &_kernelTables[kernelPlan.intrinsicType];
+    outputVideoFormat.tunedStripeSize = kernelPlan.outputStripeSize;
+}
 
-    INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = _vectorSize == 0 ? 8 : _vectorSize;
-    OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT = (_vectorSize == 0 ? 2 : _vectorSize) * 2;
+auto Format::Uninitialize() -> void {
+    _workerPool.reset();
 }
 
 auto Format::LookupMediaSubtype(const CLSID &mediaSubtype) -> const PixelFormat * {
@@ -130,78 +242,397 @@ auto Format::LookupMediaSubtype(const CLSID &mediaSubtype) -> const PixelFormat
     return nullptr;
 }
 
+auto Format::LookupOutputFormats(int frameServerFormatId) -> std::vector<const PixelFormat *> {
+    std::vector<const PixelFormat *> ret;
+
+    for (const PixelFormat &pixelFormat : LookupFrameServerFormatId(frameServerFormatId)) {
+        ret.emplace_back(&pixelFormat);
+    }
+
+    // as fallback, the semi-planar formats of lower bit depth, which CopyToOutput() reduces to with ordered dither
+    for (const int bitsPerComponent : { 10, 8 }) {
+        if (const std::optional<int> optReducedFormatId = GetReducedFrameServerFormatId(frameServerFormatId, bitsPerComponent)) {
+            for (const PixelFormat &pixelFormat : LookupFrameServerFormatId(*optReducedFormatId)) {
+                if (pixelFormat.srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED) {
+                    ret.emplace_back(&pixelFormat);
+                }
+            }
+        }
+    }
+
+    // then the semi-planar formats of other chroma subsampling, which CopyToOutput() resamples to while interleaving
+    for (const auto &[subsampleWidthRatio, subsampleHeightRatio] : { std::pair { 2, 2 }, std::pair { 2, 1 }, std::pair { 1, 1 } }) {
+        if (const std::optional<int> optResampledFormatId = GetResampledFrameServerFormatId(frameServerFormatId, subsampleWidthRatio, subsampleHeightRatio)) {
+            for (const PixelFormat &pixelFormat : LookupFrameServerFormatId(*optResampledFormatId)) {
+                if (pixelFormat.srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED) {
+                    ret.emplace_back(&pixelFormat);
+                }
+            }
+        }
+    }
+
+    if (Environment::GetInstance().IsRGB32OutputEnabled() && IsConvertibleToRGB32(frameServerFormatId)) {
+        // for the renderers that only accept RGB, CopyToOutput() converts the script output in the same pass as the copy
+        ret.emplace_back(LookupMediaSubtype(MEDIASUBTYPE_RGB32));
+    }
+
+    return ret;
+}
+
+auto Format::GetYUVToRGBCoefficients(const VideoFormat &videoFormat) -> YUVToRGBCoefficients {
+    double kr;
+    double kb;
+    switch (videoFormat.colorSpaceInfo.matrix) {
+    case VSMatrixCoefficients::VSC_MATRIX_BT709:
+        kr = 0.2126;
+        kb = 0.0722;
+        break;
+    case VSMatrixCoefficients::VSC_MATRIX_BT2020_NCL:
+        // the constant luminance variant needs the luma in linear light, which a matrix cannot produce. ColorSpaceInfo::Update() never reports it
+        kr = 0.2627;
+        kb = 0.0593;
+        break;
+    case VSMatrixCoefficients::VSC_MATRIX_BT470_BG:
+    case VSMatrixCoefficients::VSC_MATRIX_ST170_M:
+        kr = 0.299;
+        kb = 0.114;
+        break;
+    default:
+        // same guess as most renderers: BT.709 for HD, BT.601 for SD
+        if (videoFormat.videoInfo.height > 576) {
+            kr = 0.2126;
+            kb = 0.0722;
+        } else {
+            kr = 0.299;
+            kb = 0.114;
+        }
+        break;
+    }
+    const double kg = 1 - kr - kb;
+
+    // limited range unless the source says otherwise
+    const bool isFullRange = videoFormat.colorSpaceInfo.colorRange == VSColorRange::VSC_RANGE_FULL;
+    const double lumaScale = isFullRange ? 1 : 255.0 / 219;
+    const double chromaScale = isFullRange ? 1 : 255.0 / 224;
+
+    const auto ToFixedPoint = [](double coeff) -> int16_t {
+        return static_cast<int16_t>(std::lround(coeff * (1 << 13)));
+    };
+
+    return {
+        .lumaOffset = static_cast<int16_t>(isFullRange ? 0 : 16),
+        .luma = ToFixedPoint(lumaScale),
+        .crToR = ToFixedPoint(2 * (1 - kr) * chromaScale),
+        .cbToG = ToFixedPoint(2 * kb * (1 - kb) / kg * chromaScale),
+        .crToG = ToFixedPoint(2 * kr * (1 - kr) / kg * chromaScale),
+        .cbToB = ToFixedPoint(2 * (1 - kb) * chromaScale),
+    };
+}
+
+auto Format::GetV210Stride(int width) -> int {
+    // each row of v210 is aligned to 128 bytes, which is 48 pixels
+    return DivideRoundUp(width, V210_BLOCK_PIXELS * 8) * V210_BLOCK_SIZE * 8;
+}
+
+auto Format::GetBitmapImageSize(const BITMAPINFOHEADER &bmi) -> DWORD {
+    // biBitCount of v210 is only nominal, thus GetBitmapSize() does not apply
+    if (bmi.biCompression == MEDIASUBTYPE_V210.Data1) {
+        return static_cast<DWORD>(GetV210Stride(bmi.biWidth) * abs(bmi.biHeight));
+    }
+
+    return GetBitmapSize(&bmi);
+}
+
 auto Format::GetStrideAlignedMediaSampleSize(const AM_MEDIA_TYPE &mediaType, int strideAlignment) -> long {
     BITMAPINFOHEADER bmi = *GetBitmapInfo(mediaType);
     bmi.biWidth = FFALIGN(bmi.biWidth, strideAlignment);
-    return GetBitmapSize(&bmi);
+    return GetBitmapImageSize(bmi);
 }
 
-auto Format::DeinterleaveY410(const BYTE *src, int srcStride, std::array<BYTE *, 3> dsts, const std::array<int, 3> &dstStrides, int rowSize, int height) -> void {
-    // process one plane at a time by zeroing all other planes, shuffle it from different pixels together, and fix the position by right shifting
-
-    Environment::GetInstance().Log(L"DeinterleaveY410() start");
+auto Format::IsStreamingAligned(const VideoFormat &videoFormat, const BYTE *buffer, int stride) -> bool {
+    // every row must start at an address aligned to the vector size
+    const int vectorSize = videoFormat.kernels->vectorSize;
+    return vectorSize > 0 && reinterpret_cast<uintptr_t>(buffer) % vectorSize == 0 && stride % vectorSize == 0;
+}
 
-    using Input = __m128i;
-    using Output = uint64_t;
+/**
+ * Byte offsets of the pixel column from the start of the rows of the main plane and of the chroma planes.
+ * v210 can only start at the boundary of its blocks, thus the column is rounded down to the block.
+ */
+auto Format::GetPlaneColumnOffsets(const PixelFormat &pixelFormat, int column, int componentSize) -> std::array<int, 2> {
+    const int subsampleWidthRatio = std::max(pixelFormat.subsampleWidthRatio, 1);
+
+    switch (pixelFormat.srcPlanesLayout) {
+    case PlanesLayout::ALL_PLANES_INTERLEAVED:
+        return { column * (pixelFormat.bitCount / 8), 0 };
+    case PlanesLayout::ALL_PLANES_BIT_PACKED:
+        return { column / V210_BLOCK_PIXELS * V210_BLOCK_SIZE, 0 };
+    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED:
+        return { column * componentSize, column / subsampleWidthRatio * componentSize * 2 };
+    default:
+        return { column * componentSize, column / subsampleWidthRatio * componentSize };
+    }
+}
 
-    for (int y = 0; y < height; ++y) {
-        const Input *srcLine = reinterpret_cast<const Input *>(src);
-        std::array<Output *, dsts.size()> dstsLine;
-        for (size_t p = 0; p < dsts.size(); ++p) {
-            dstsLine[p] = reinterpret_cast<Output *>(dsts[p]);
-        }
+/**
+ * The output kernels store whole vectors to aligned addresses, and may write up to OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT past the end of each row.
+ * Thus rcTarget must start and end at the aligned columns of every plane, or else the picture would be moved or its surroundings overwritten.
+ * The right edge of the buffer is always fine, since the stride is padded for the kernels.
+ */
+auto Format::IsTargetAligned(const AM_MEDIA_TYPE &mediaType) -> bool {
+    const RECT &rcTarget = reinterpret_cast<const VIDEOINFOHEADER *>(mediaType.pbFormat)->rcTarget;
+    const PixelFormat *pixelFormat = LookupMediaSubtype(mediaType.subtype);
+    if (IsRectEmpty(&rcTarget) || pixelFormat == nullptr) {
+        return true;
+    }
 
-        for (int i = 0; i < DivideRoundUp(rowSize, sizeof(Input)); ++i) {
-            const Input srcVec = *srcLine++;
+    if (pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED && rcTarget.left % V210_BLOCK_PIXELS != 0) {
+        return false;
+    }
 
-            const Input dataVec1 = _mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_1), _Y410_SHUFFLE_MASK_1);
-            const Input dataVec2 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_2), _Y410_SHUFFLE_MASK_2), 2);
-            const Input dataVec3 = _mm_srli_epi32(_mm_shuffle_epi8(_mm_and_si128(srcVec, _Y410_AND_MASK_3), _Y410_SHUFFLE_MASK_3), 4);
+    // biBitCount of the planar formats covers the main plane and the subsampled chroma planes
+    const int subsampleArea = std::max(pixelFormat->subsampleWidthRatio, 1) * std::max(pixelFormat->subsampleHeightRatio, 1);
+    const int componentSize = pixelFormat->bitCount * subsampleArea / ((subsampleArea + 2) * 8);
 
-            *dstsLine[0]++ = *reinterpret_cast<const Output *>(&dataVec1);
-            *dstsLine[1]++ = *reinterpret_cast<const Output *>(&dataVec2);
-            *dstsLine[2]++ = *reinterpret_cast<const Output *>(&dataVec3);
+    for (const LONG column : { rcTarget.left, rcTarget.right }) {
+        if (column == GetBitmapInfo(mediaType)->biWidth) {
+            continue;
         }
 
-        src += srcStride;
-        for (size_t p = 0; p < dsts.size(); ++p) {
-            dsts[p] += dstStrides[p];
+        for (const int columnOffset : GetPlaneColumnOffsets(*pixelFormat, column, componentSize)) {
+            if (columnOffset % OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT != 0) {
+                return false;
+            }
         }
     }
 
-    Environment::GetInstance().Log(L"DeinterleaveY410() end");
+    return true;
+}
+
+/**
+ * Byte offsets from the start of the main plane and of each chroma plane to the visible region of the sample buffer.
+ * For bottom-up DIBs, the visible region starts from the row at the bottom in memory.
+ *
+ * The input side realigns the region through ReadInBands(), while the output side only accepts rcTarget that IsTargetAligned().
+ */
+auto Format::GetBufferPlan(const VideoFormat &videoFormat, int left, int top, int componentSize, bool isInverted) -> VideoFormat::BufferPlan {
+    const int height = videoFormat.videoInfo.height;
+    const int bufferHeight = abs(videoFormat.bmi.biHeight);
+    const int firstRow = videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight > 0 ? bufferHeight - top - height : top;
+    const int subsampleWidthRatio = std::max(videoFormat.pixelFormat->subsampleWidthRatio, 1);
+    const int subsampleHeightRatio = std::max(videoFormat.pixelFormat->subsampleHeightRatio, 1);
+    const auto [mainPlaneColumnOffset, uvPlaneColumnOffset] = GetPlaneColumnOffsets(*videoFormat.pixelFormat, left, componentSize);
+
+    int mainPlaneStride;
+    int uvPlaneStride = 0;
+    // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
+    switch (videoFormat.pixelFormat->srcPlanesLayout) {
+    case PlanesLayout::ALL_PLANES_INTERLEAVED:
+        mainPlaneStride = videoFormat.bmi.biWidth * (videoFormat.pixelFormat->bitCount / 8);
+        break;
+    case PlanesLayout::ALL_PLANES_BIT_PACKED:
+        mainPlaneStride = GetV210Stride(videoFormat.bmi.biWidth);
+        break;
+    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED:
+        mainPlaneStride = videoFormat.bmi.biWidth * componentSize;
+        uvPlaneStride = mainPlaneStride * 2 / subsampleWidthRatio;
+        break;
+    default:
+        mainPlaneStride = videoFormat.bmi.biWidth * componentSize;
+        uvPlaneStride = mainPlaneStride / subsampleWidthRatio;
+        break;
+    }
+
+    ASSERT(firstRow >= 0 && firstRow + height <= bufferHeight);
+    const ptrdiff_t mainPlaneSize = static_cast<ptrdiff_t>(mainPlaneStride) * bufferHeight;
+    const ptrdiff_t uvPlaneOffset = mainPlaneSize + static_cast<ptrdiff_t>(top / subsampleHeightRatio) * uvPlaneStride + uvPlaneColumnOffset;
+
+    VideoFormat::BufferPlan ret {
+        .mainPlaneStride = mainPlaneStride,
+        .uvPlaneStride = uvPlaneStride,
+        .planeOffsets = { static_cast<ptrdiff_t>(firstRow) * mainPlaneStride + mainPlaneColumnOffset, uvPlaneOffset, uvPlaneOffset },
+    };
+
+    if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE) {
+        ret.planeOffsets[2] += mainPlaneSize / (subsampleWidthRatio * subsampleHeightRatio);
+    }
+
+    if (isInverted) {
+        ret.planeOffsets[0] += static_cast<ptrdiff_t>(height - 1) * mainPlaneStride;
+        ret.mainPlaneStride = -mainPlaneStride;
+    }
+
+    return ret;
 }
 
-auto Format::InterleaveY410(std::array<const BYTE *, 3> srcs, const std::array<int, 3> &srcStrides, BYTE *dst, int dstStride, int rowSize, int height) -> void {
-    // expand each 16-bit integer to 32-bit, left shift to right position and OR them all
-    // due the expansion, only half the size for each source vector is used, therefore we need to cast
+/**
+ * Call bandFunc(bandSrc, bandSrcStride, bandFirstRow, bandHeight) over the source rows.
+ * With isStreamLoad, each band is first copied with streaming loads into a small cacheable bounce buffer,
+ * so that the conversion kernels never read from the write-combined or uncached source.
+ * The source cropped by rcSource may also start off the vector alignment, which is realigned through the same bounce buffer.
+ */
+auto Format::ReadInBands(const VideoFormat &videoFormat, const BYTE *src, int srcStride, int rowSize, int height, bool isStreamLoad, const std::function<void(const BYTE *, int, int, int)> &bandFunc) -> void {
+    const int vectorSize = videoFormat.kernels->vectorSize;
+    // the streaming loads also need every row aligned, which the stride of the chroma planes of YV12 and I420 may not be
+    const bool isMisaligned = vectorSize > 0 && (reinterpret_cast<uintptr_t>(src) % vectorSize != 0 || (isStreamLoad && srcStride % vectorSize != 0));
+    if (!isStreamLoad && !isMisaligned) {
+        bandFunc(src, srcStride, 0, height);
+        return;
+    }
 
-    Environment::GetInstance().Log(L"InterleaveY410() start");
+    // keep the same padding as the input media sample, since the kernels may read past the row size up to the alignment
+    const int bounceStride = DivideRoundUp(rowSize, INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT) * INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT;
+    const int bandHeight = std::max(BOUNCE_BUFFER_SIZE / bounceStride, 1);
+    _bounceBuffer.resize(static_cast<size_t>(bounceStride) * bandHeight + INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT);
+    BYTE *bounceBuffer = _bounceBuffer.data() + (INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT - reinterpret_cast<uintptr_t>(_bounceBuffer.data()) % INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT) % INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT;
+
+    for (int bandFirstRow = 0; bandFirstRow < height; bandFirstRow += bandHeight) {
+        const int currentBandHeight = std::min(bandHeight, height - bandFirstRow);
+        const BYTE *bandSrc = src + static_cast<ptrdiff_t>(bandFirstRow) * srcStride;
+        if (isMisaligned) {
+            for (int y = 0; y < currentBandHeight; ++y) {
+                memcpy(bounceBuffer + static_cast<ptrdiff_t>(y) * bounceStride, bandSrc + static_cast<ptrdiff_t>(y) * srcStride, rowSize);
+            }
+        } else {
+            videoFormat.kernels->streamLoadCopyFunc(bandSrc, srcStride, bounceBuffer, bounceStride, rowSize, currentBandHeight);
+        }
+        bandFunc(bounceBuffer, bounceStride, bandFirstRow, currentBandHeight);
+    }
+}
 
-    using Input = uint64_t;
-    using Output = __m128i;
+/**
+ * Interleave the U and V planes of the script output to the semi-planar output of a different chroma subsampling, one output row at a time.
+ * When the vertical subsampling differs, the output row is first filtered from the two nearest source rows into a small per-thread buffer.
+ * The horizontal filter is then fused with the interleaving.
+ *
+ * frameWidth and height are in luma pixels, and uvFirstRow and uvRows in the output chroma rows of the stripe.
+ */
+auto Format::ResampleInterleaveUV(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, int srcSubsampleWidthRatio, int srcSubsampleHeightRatio, BYTE *dstUVPlane, int dstUVStride, int frameWidth, int height, int componentSize, bool isLeftShiftNeeded, int uvFirstRow, int uvRows) -> void {
+    const int dstSubsampleWidthRatio = videoFormat.pixelFormat->subsampleWidthRatio;
+    const int dstSubsampleHeightRatio = videoFormat.pixelFormat->subsampleHeightRatio;
+    const int srcUVWidth = DivideRoundUp(frameWidth, srcSubsampleWidthRatio);
+    const int srcUVHeight = DivideRoundUp(height, srcSubsampleHeightRatio);
+    const int dstUVWidth = DivideRoundUp(frameWidth, dstSubsampleWidthRatio);
+    const int srcUVRowSize = srcUVWidth * componentSize;
+    const KernelTable &kernels = *videoFormat.kernels;
+
+    BYTE *rowBuffer = nullptr;
+    int rowBufferStride = 0;
+    if (srcSubsampleHeightRatio != dstSubsampleHeightRatio) {
+        // the horizontal stage may read up to two vectors past the row
+        const int alignment = std::max(kernels.vectorSize, 16) * 2;
+        rowBufferStride = DivideRoundUp(srcUVRowSize, alignment) * alignment;
+        _chromaRowBuffer.resize(static_cast<size_t>(rowBufferStride) * 2 + alignment);
+        rowBuffer = _chromaRowBuffer.data() + (alignment - reinterpret_cast<uintptr_t>(_chromaRowBuffer.data()) % alignment) % alignment;
+    }
 
-    for (int y = 0; y < height; ++y) {
-        std::array<const Input *, srcs.size()> srcsLine;
-        for (size_t p = 0; p < srcs.size(); ++p) {
-            srcsLine[p] = reinterpret_cast<const Input *>(srcs[p]);
+    for (int row = uvFirstRow; row < uvFirstRow + uvRows; ++row) {
+        std::array<const BYTE *, 2> srcRows;
+
+        if (rowBuffer == nullptr) {
+            for (size_t p = 0; p < srcRows.size(); ++p) {
+                srcRows[p] = srcSlices[p + 1] + static_cast<ptrdiff_t>(row) * srcStrides[p + 1];
+            }
+        } else {
+            int srcRow1;
+            int srcRow2;
+            bool isWeighted;
+            if (srcSubsampleHeightRatio < dstSubsampleHeightRatio) {
+                // the output chroma row is centered between the two source rows
+                srcRow1 = row * 2;
+                srcRow2 = std::min(row * 2 + 1, srcUVHeight - 1);
+                isWeighted = false;
+            } else {
+                // the output chroma row is a quarter of the way from the nearest source row to the next nearest one
+                srcRow1 = row / 2;
+                srcRow2 = std::clamp(row % 2 == 0 ? srcRow1 - 1 : srcRow1 + 1, 0, srcUVHeight - 1);
+                isWeighted = true;
+            }
+
+            for (size_t p = 0; p < srcRows.size(); ++p) {
+                BYTE *bufferRow = rowBuffer + p * rowBufferStride;
+                (componentSize == 1 ? kernels.averageRowsC1Func : kernels.averageRowsC2Func)(srcSlices[p + 1] + static_cast<ptrdiff_t>(srcRow1) * srcStrides[p + 1],
+                                                                                srcSlices[p + 1] + static_cast<ptrdiff_t>(srcRow2) * srcStrides[p + 1],
+                                                                                bufferRow, srcUVRowSize, isWeighted);
+                srcRows[p] = bufferRow;
+            }
         }
-        Output *dstLine = reinterpret_cast<Output *>(dst);
 
-        for (int i = 0; i < DivideRoundUp(rowSize, sizeof(Output)); ++i) {
-            const Output vec1 = _mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[0]++));
-            const Output vec2 = _mm_slli_epi32(_mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[1]++)), 10);
-            const Output vec3 = _mm_slli_epi32(_mm_cvtepu16_epi32(*reinterpret_cast<const Output *>(srcsLine[2]++)), 20);
-            *dstLine++ = _mm_or_si128(_mm_or_si128(vec1, vec2), vec3);
+        BYTE *dstRow = dstUVPlane + static_cast<ptrdiff_t>(row) * dstUVStride;
+
+        if (srcSubsampleWidthRatio == dstSubsampleWidthRatio) {
+            decltype(kernels.interleaveUVC1Func) interleaveFunc;
+            if (componentSize == 1) {
+                interleaveFunc = kernels.interleaveUVC1Func;
+            } else if (isLeftShiftNeeded) {
+                interleaveFunc = kernels.interleaveUVC2ShiftFunc;
+            } else {
+                interleaveFunc = kernels.interleaveUVC2Func;
+            }
+            interleaveFunc(srcRows[0], srcRows[1], 0, 0, dstRow, dstUVStride, dstUVWidth * componentSize * 2, 1);
+        } else {
+            decltype(kernels.uvDownsampleC1Func) resampleFunc;
+            if (srcSubsampleWidthRatio < dstSubsampleWidthRatio) {
+                resampleFunc = componentSize == 1 ? kernels.uvDownsampleC1Func : kernels.uvDownsampleC2Func;
+            } else {
+                resampleFunc = componentSize == 1 ? kernels.uvUpsampleC1Func : kernels.uvUpsampleC2Func;
+            }
+            resampleFunc(srcRows[0], srcRows[1], dstRow, dstUVWidth, srcUVWidth, isLeftShiftNeeded ? 6 : 0);
         }
+    }
+}
 
-        for (size_t p = 0; p < srcs.size(); ++p) {
-            srcs[p] += srcStrides[p];
+/**
+ * Call stripeFunc(mainFirstRow, mainRows, uvFirstRow, uvRows) for each stripe of the frame, so that all planes of a stripe
+ * are fully converted while the data is still in cache, instead of converting one whole plane at a time.
+ * The stripe height is either picked by the kernel autotuning, configured per format, or derived from the size of the L2 cache.
+ *
+ * With the worker pool, the frame is first split into row ranges, one per task. Stripes never cross the task boundary.
+ */
+auto Format::ForEachStripe(const VideoFormat &videoFormat, int mainPlaneStride, int height, const std::function<void(int, int, int, int)> &stripeFunc) -> void {
+    // RGB formats have negative subsample ratios
+    const int subsampleWidthRatio = std::max(videoFormat.pixelFormat->subsampleWidthRatio, 1);
+    const int subsampleHeightRatio = std::max(videoFormat.pixelFormat->subsampleHeightRatio, 1);
+    const int uvHeight = height / subsampleHeightRatio;
+
+    int stripeHeight = videoFormat.tunedStripeSize.value_or(Environment::GetInstance().GetStripeSize(videoFormat.pixelFormat->name));
+    if (stripeHeight == 0) {
+        // source and destination of all planes in a stripe should take no more than half of the L2 cache
+        int64_t bytesPerRow = std::abs(mainPlaneStride) * 2LL;
+        if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED || videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE) {
+            bytesPerRow += bytesPerRow * 2 / (subsampleWidthRatio * subsampleHeightRatio);
         }
-        dst += dstStride;
+        stripeHeight = static_cast<int>(Environment::GetInstance().GetL2CacheSize() / 2 / bytesPerRow);
+    } else if (stripeHeight < 0) {
+        stripeHeight = height;
     }
+    // every stripe and task must contain whole subsampled rows
+    stripeHeight = std::max(stripeHeight / subsampleHeightRatio, 1) * subsampleHeightRatio;
+
+    int taskHeight = height;
+    if (_workerPool != nullptr) {
+        const int numTasks = std::clamp(height / Environment::GetInstance().GetMinRowsPerConversionTask(), 1, _workerPool->GetNumThreads());
+        taskHeight = DivideRoundUp(DivideRoundUp(height, numTasks), subsampleHeightRatio) * subsampleHeightRatio;
+    }
+
+    const auto RunTask = [&](int task) -> void {
+        const int taskFirstRow = task * taskHeight;
+        const int taskEndRow = std::min(taskFirstRow + taskHeight, height);
 
-    Environment::GetInstance().Log(L"InterleaveY410() end");
+        for (int mainFirstRow = taskFirstRow; mainFirstRow < taskEndRow; mainFirstRow += stripeHeight) {
+            const int mainRows = std::min(stripeHeight, taskEndRow - mainFirstRow);
+            const int uvFirstRow = mainFirstRow / subsampleHeightRatio;
+            const int uvRows = std::min((mainFirstRow + mainRows) / subsampleHeightRatio, uvHeight) - uvFirstRow;
+
+            stripeFunc(mainFirstRow, mainRows, uvFirstRow, uvRows);
+        }
+    };
+
+    if (const int numTasks = DivideRoundUp(height, taskHeight); numTasks == 1) {
+        RunTask(0);
+    } else {
+        _workerPool->Run(numTasks, RunTask);
+    }
 }
 
 }
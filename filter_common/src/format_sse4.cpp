@@ -0,0 +1,67 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "environment.h"
+#include "macros.h"
+#include "simd.h"
+#include "util.h"
+#include "worker_pool.h"
+
+// every header above keeps the baseline instruction set, only the kernels of Format below are compiled for SSE4.2
+BEGIN_TARGET_ISA("sse4.2")
+#include "format.h"
+
+
+namespace SynthFilter {
+
+auto Format::InitializeSSE4(KernelTable &kernels) -> void {
+    kernels.deinterleaveUVC1Func          = Deinterleave<1, 1, 2, 2, 1>;
+    kernels.deinterleaveUVC2Func          = Deinterleave<1, 2, 2, 2, 1>;
+    kernels.deinterleaveUVC2ShiftFunc     = Deinterleave<1, 2, 2, 2, 1, 6>;
+    kernels.deinterleaveY416Func          = Deinterleave<1, 2, 4, 3, 1>;
+    kernels.deinterleaveRGBC1Func         = Deinterleave<1, 1, 4, 3, 2>;
+    kernels.deinterleaveY410Func          = DeinterleaveY410<1>;
+    kernels.deinterleaveRGB24Func         = DeinterleaveRGB<1, 1>;
+    kernels.deinterleaveRGB48Func         = DeinterleaveRGB<1, 2>;
+    kernels.interleaveUVC1Func            = InterleaveUV<1, 1>;
+    kernels.interleaveUVC2Func            = InterleaveUV<1, 2>;
+    kernels.interleaveUVC2ShiftFunc       = InterleaveUV<1, 2, 6>;
+    kernels.interleaveUVC2ShiftStreamFunc = InterleaveUV<1, 2, 6, true>;
+    kernels.interleaveY416Func            = InterleaveThree<1, 1>;
+    kernels.interleaveRGBC1Func           = InterleaveThree<1, 2>;
+    kernels.interleaveY410Func            = InterleaveY410<1>;
+    kernels.deinterleaveY210Func          = DeinterleaveYUYV<1, 2, 6>;
+    kernels.deinterleaveY216Func          = DeinterleaveYUYV<1, 2>;
+    kernels.interleaveY210Func            = InterleaveYUYV<1, 2, 6>;
+    kernels.interleaveY216Func            = InterleaveYUYV<1, 2>;
+    kernels.deinterleaveYUY2Func          = DeinterleaveYUYV<1, 1>;
+    kernels.deinterleaveUYVYFunc          = DeinterleaveYUYV<1, 1, 0, true>;
+    kernels.interleaveYUY2Func            = InterleaveYUYV<1, 1>;
+    kernels.interleaveUYVYFunc            = InterleaveYUYV<1, 1, 0, true>;
+    kernels.unpackV210Func                = UnpackV210<1>;
+    kernels.packV210Func                  = PackV210<1>;
+    kernels.interleaveRGB24Func           = InterleaveRGB<1, 1>;
+    kernels.interleaveRGB48Func           = InterleaveRGB<1, 2>;
+    kernels.swapRedBlue48Func             = SwapRedBlue<1, 3>;
+    kernels.swapRedBlue64Func             = SwapRedBlue<1, 4>;
+    kernels.reduceBitDepthC1Func          = ReduceBitDepth<1, 8>;
+    kernels.reduceBitDepthC2Func          = ReduceBitDepth<1, 10>;
+    kernels.interleaveUVReduceC1Func      = InterleaveUVReduceBitDepth<1, 8>;
+    kernels.interleaveUVReduceC2Func      = InterleaveUVReduceBitDepth<1, 10>;
+    kernels.yuvToRGB32Func                = ConvertYUVToRGB32<1, 1>;
+    kernels.yuvToRGB32SubsampledFunc      = ConvertYUVToRGB32<1, 2>;
+    kernels.averageRowsC1Func             = AverageRows<1, 1>;
+    kernels.averageRowsC2Func             = AverageRows<1, 2>;
+    kernels.uvDownsampleC1Func            = InterleaveUVResample<1, 1, true>;
+    kernels.uvDownsampleC2Func            = InterleaveUVResample<1, 2, true>;
+    kernels.uvUpsampleC1Func              = InterleaveUVResample<1, 1, false>;
+    kernels.uvUpsampleC2Func              = InterleaveUVResample<1, 2, false>;
+    kernels.rightShiftFunc                = BitShiftEach16BitInt<1, 6, true>;
+    kernels.leftShiftFunc                 = BitShiftEach16BitInt<1, 6, false>;
+    kernels.leftShiftStreamFunc           = BitShiftEach16BitInt<1, 6, false, true>;
+    kernels.streamLoadCopyFunc            = StreamLoadCopy<1>;
+    kernels.vectorSize                    = sizeof(__m128i);
+}
+
+}
+
+END_TARGET_ISA
@@ -56,8 +56,6 @@ auto AuxFrameServer::GenerateMediaType(const Format::PixelFormat &pixelFormat, c
     newBmi->biWidth = _scriptVideoInfo.width;
     newBmi->biHeight = _scriptVideoInfo.height;
     newBmi->biBitCount = pixelFormat.bitCount;
-    newBmi->biSizeImage = GetBitmapSize(newBmi);
-    newMediaType.SetSampleSize(newBmi->biSizeImage);
 
     if (fourCC == pixelFormat.mediaSubtype) {
         // uncompressed formats (such as RGB32) have different GUIDs
@@ -66,6 +64,9 @@ auto AuxFrameServer::GenerateMediaType(const Format::PixelFormat &pixelFormat, c
         newBmi->biCompression = BI_RGB;
     }
 
+    newBmi->biSizeImage = Format::GetBitmapImageSize(*newBmi);
+    newMediaType.SetSampleSize(newBmi->biSizeImage);
+
     return newMediaType;
 }
 
@@ -16,6 +16,31 @@ namespace SynthFilter {
 // from FFmpeg
 #define FFALIGN(x, alignment) (((x) + (alignment) -1) & ~((alignment) -1))
 
+#define PRAGMA(x) _Pragma(#x)
+
+// GCC and Clang only allow the intrinsics of the instruction sets that each function is compiled for, while MSVC allows all of them anywhere
+#if defined(__clang__)
+    #define BEGIN_TARGET_ISA(isa) PRAGMA(clang attribute push(__attribute__((target(isa))), apply_to = function))
+    #define END_TARGET_ISA        PRAGMA(clang attribute pop)
+#elif defined(__GNUC__)
+    #define BEGIN_TARGET_ISA(isa) PRAGMA(GCC push_options) PRAGMA(GCC target(isa))
+    #define END_TARGET_ISA        PRAGMA(GCC pop_options)
+#else
+    #define BEGIN_TARGET_ISA(isa)
+    #define END_TARGET_ISA
+#endif
+
+/*
+ * Every function defined between BEGIN_TARGET_ISA and END_TARGET_ISA is compiled for that instruction set, including the inline helpers
+ * that the baseline code uses too. Their out-of-line copies are merged by the linker, which may keep the one compiled for the wider ISA.
+ * Helpers shared by the baseline and the SIMD kernels are forced inline, so that no such copy is ever emitted.
+ */
+#ifdef _MSC_VER
+    #define FORCE_INLINE __forceinline
+#else
+    #define FORCE_INLINE __attribute__((always_inline)) inline
+#endif
+
 #define CheckHr(expr)     \
     {                     \
         hr = (expr);      \
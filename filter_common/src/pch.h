@@ -10,15 +10,18 @@
 #include <array>
 #include <chrono>
 #include <clocale>
+#include <cmath>
 #include <condition_variable>
 #include <filesystem>
 #include <format>
+#include <fstream>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <numeric>
 #include <optional>
+#include <random>
 #include <ranges>
 #include <regex>
 #include <shared_mutex>
@@ -37,6 +40,11 @@
 #include <dxva.h>
 #include <immintrin.h>
 #include <initguid.h>
+#ifdef _MSC_VER
+    #include <intrin.h>
+#else
+    #include <cpuid.h>
+#endif
 #include <processthreadsapi.h>
 #include <shellapi.h>
 
@@ -40,7 +40,17 @@
 #define IDC_INPUT_FORMAT_Y416            1212
 #define IDC_INPUT_FORMAT_RGB24           1213
 #define IDC_INPUT_FORMAT_RGB32           1214
-#define IDC_INPUT_FORMAT_END             1215
+#define IDC_INPUT_FORMAT_RGB48           1215
+#define IDC_INPUT_FORMAT_RGB64           1216
+#define IDC_INPUT_FORMAT_V210            1217
+#define IDC_INPUT_FORMAT_Y210            1218
+#define IDC_INPUT_FORMAT_Y216            1219
+#define IDC_INPUT_FORMAT_UYVY            1220
+#define IDC_INPUT_FORMAT_NV24            1221
+#define IDC_INPUT_FORMAT_P410            1222
+#define IDC_INPUT_FORMAT_P416            1223
+#define IDC_INPUT_FORMAT_AYUV            1224
+#define IDC_INPUT_FORMAT_END             1225
 
 #define IDT_TIMER_STATUS                 2000
 #define IDC_TEXT_FRAME_NUMBER            2001
@@ -0,0 +1,131 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+
+namespace SynthFilter {
+
+/*
+ * Minimal 128-bit vector abstraction for the portable kernels (intrinsicType 0), which run when none of the x86 tiers is available.
+ * The backend only uses SSE2, which every x86 CPU the filters support has. There is no ARM backend, since the filters are only built for x86 and x64.
+ * Defining AVSF_SIMD_EMULATION selects plain byte arrays instead, to validate the portable kernels against the x86 tiers.
+ */
+class Simd {
+public:
+#if defined(AVSF_SIMD_EMULATION)
+    using Vector = std::array<uint8_t, 16>;
+#else
+    using Vector = __m128i;
+#endif
+
+    static constexpr int VECTOR_SIZE = 16;
+
+    static auto Load(const void *src) -> Vector {
+#if defined(AVSF_SIMD_EMULATION)
+        Vector ret;
+        memcpy(ret.data(), src, VECTOR_SIZE);
+        return ret;
+#else
+        return _mm_loadu_si128(static_cast<const __m128i *>(src));
+#endif
+    }
+
+    static auto Store(void *dst, const Vector &vec) -> void {
+#if defined(AVSF_SIMD_EMULATION)
+        memcpy(dst, vec.data(), VECTOR_SIZE);
+#else
+        _mm_storeu_si128(static_cast<__m128i *>(dst), vec);
+#endif
+    }
+
+    /*
+     * Interleave the components of vec1 and vec2 alternately.
+     * dstVecLo gets the interleaved lower halves, dstVecHi the upper halves.
+     */
+    template <int componentSize>
+    static auto Zip(const Vector &vec1, const Vector &vec2, Vector &dstVecLo, Vector &dstVecHi) -> void {
+#if defined(AVSF_SIMD_EMULATION)
+        constexpr int halfSize = VECTOR_SIZE / 2;
+
+        for (int i = 0; i < halfSize; i += componentSize) {
+            memcpy(&dstVecLo[i * 2], &vec1[i], componentSize);
+            memcpy(&dstVecLo[i * 2 + componentSize], &vec2[i], componentSize);
+            memcpy(&dstVecHi[i * 2], &vec1[halfSize + i], componentSize);
+            memcpy(&dstVecHi[i * 2 + componentSize], &vec2[halfSize + i], componentSize);
+        }
+#else
+        if constexpr (componentSize == 1) {
+            dstVecLo = _mm_unpacklo_epi8(vec1, vec2);
+            dstVecHi = _mm_unpackhi_epi8(vec1, vec2);
+        } else if constexpr (componentSize == 2) {
+            dstVecLo = _mm_unpacklo_epi16(vec1, vec2);
+            dstVecHi = _mm_unpackhi_epi16(vec1, vec2);
+        }
+#endif
+    }
+
+    /*
+     * Inverse of Zip(). The components at the even positions of vec1 followed by vec2 go to dstVecEven, the odd ones to dstVecOdd.
+     */
+    template <int componentSize>
+    static auto Unzip(const Vector &vec1, const Vector &vec2, Vector &dstVecEven, Vector &dstVecOdd) -> void {
+#if defined(AVSF_SIMD_EMULATION)
+        constexpr int halfSize = VECTOR_SIZE / 2;
+
+        for (int i = 0; i < halfSize; i += componentSize) {
+            memcpy(&dstVecEven[i], &vec1[i * 2], componentSize);
+            memcpy(&dstVecOdd[i], &vec1[i * 2 + componentSize], componentSize);
+            memcpy(&dstVecEven[halfSize + i], &vec2[i * 2], componentSize);
+            memcpy(&dstVecOdd[halfSize + i], &vec2[i * 2 + componentSize], componentSize);
+        }
+#else
+        if constexpr (componentSize == 1) {
+            // PSHUFB is SSSE3, so split the bytes of each 16-bit integer and pack them back with saturation instead
+            const __m128i lowByteMask = _mm_set1_epi16(0x00FF);
+            dstVecEven = _mm_packus_epi16(_mm_and_si128(vec1, lowByteMask), _mm_and_si128(vec2, lowByteMask));
+            dstVecOdd = _mm_packus_epi16(_mm_srli_epi16(vec1, 8), _mm_srli_epi16(vec2, 8));
+        } else if constexpr (componentSize == 2) {
+            // move the even 16-bit integers of each vector to the lower 64 bits and the odd ones to the upper 64 bits
+            const auto Gather = [](const __m128i &vec) -> __m128i {
+                return _mm_shuffle_epi32(_mm_shufflehi_epi16(_mm_shufflelo_epi16(vec, 0b11011000), 0b11011000), 0b11011000);
+            };
+            const __m128i gather1 = Gather(vec1);
+            const __m128i gather2 = Gather(vec2);
+            dstVecEven = _mm_unpacklo_epi64(gather1, gather2);
+            dstVecOdd = _mm_unpackhi_epi64(gather1, gather2);
+        }
+#endif
+    }
+
+    template <int shiftSize>
+    static auto ShiftLeft16(const Vector &vec) -> Vector {
+#if defined(AVSF_SIMD_EMULATION)
+        Vector ret;
+        for (int i = 0; i < VECTOR_SIZE; i += 2) {
+            const uint16_t component = static_cast<uint16_t>((vec[i] | vec[i + 1] << 8) << shiftSize);
+            ret[i] = static_cast<uint8_t>(component);
+            ret[i + 1] = static_cast<uint8_t>(component >> 8);
+        }
+        return ret;
+#else
+        return _mm_slli_epi16(vec, shiftSize);
+#endif
+    }
+
+    template <int shiftSize>
+    static auto ShiftRight16(const Vector &vec) -> Vector {
+#if defined(AVSF_SIMD_EMULATION)
+        Vector ret;
+        for (int i = 0; i < VECTOR_SIZE; i += 2) {
+            const uint16_t component = static_cast<uint16_t>((vec[i] | vec[i + 1] << 8) >> shiftSize);
+            ret[i] = static_cast<uint8_t>(component);
+            ret[i + 1] = static_cast<uint8_t>(component >> 8);
+        }
+        return ret;
+#else
+        return _mm_srli_epi16(vec, shiftSize);
+#endif
+    }
+};
+
+}
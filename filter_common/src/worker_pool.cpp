@@ -0,0 +1,92 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "worker_pool.h"
+
+
+namespace SynthFilter {
+
+WorkerPool::WorkerPool(int numWorkers) {
+    _workers.reserve(numWorkers);
+    for (int i = 0; i < numWorkers; ++i) {
+        _workers.emplace_back([this](std::stop_token stopToken) -> void {
+            WorkerProc(stopToken);
+        });
+    }
+}
+
+auto WorkerPool::Run(int numTasks, const std::function<void(int)> &taskFunc) -> void {
+    if (numTasks <= 1 || _workers.empty()) {
+        for (int task = 0; task < numTasks; ++task) {
+            taskFunc(task);
+        }
+        return;
+    }
+
+    Batch batch { .taskFunc = taskFunc, .numTasks = numTasks };
+    {
+        const std::unique_lock lock(_mutex);
+        _pendingBatches.emplace_back(&batch);
+    }
+    _newBatchCv.notify_all();
+
+    for (int task = ClaimTask(batch); task < numTasks; task = ClaimTask(batch)) {
+        taskFunc(task);
+        FinishTask(batch);
+    }
+
+    // the batch lives on this stack, thus must not return until every worker is done touching it
+    std::unique_lock lock(_mutex);
+    _batchFinishedCv.wait(lock, [&batch]() -> bool {
+        return batch.numFinishedTasks == batch.numTasks;
+    });
+}
+
+auto WorkerPool::WorkerProc(std::stop_token stopToken) -> void {
+    SetThreadDescription(GetCurrentThread(), L"CSynthFilter Conversion Worker");
+
+    while (true) {
+        Batch *batch;
+        int task;
+        {
+            std::unique_lock lock(_mutex);
+            if (!_newBatchCv.wait(lock, stopToken, [this]() -> bool { return !_pendingBatches.empty(); })) {
+                return;
+            }
+
+            batch = _pendingBatches.front();
+            task = batch->nextTask++;
+            if (batch->nextTask == batch->numTasks) {
+                _pendingBatches.erase(_pendingBatches.begin());
+            }
+        }
+
+        batch->taskFunc(task);
+        FinishTask(*batch);
+    }
+}
+
+auto WorkerPool::ClaimTask(Batch &batch) -> int {
+    const std::unique_lock lock(_mutex);
+
+    if (batch.nextTask == batch.numTasks) {
+        return batch.numTasks;
+    }
+
+    const int task = batch.nextTask++;
+    if (batch.nextTask == batch.numTasks) {
+        std::erase(_pendingBatches, &batch);
+    }
+    return task;
+}
+
+auto WorkerPool::FinishTask(Batch &batch) -> void {
+    // notify while holding the lock, otherwise the batch could be gone between the increment and the notification
+    const std::unique_lock lock(_mutex);
+
+    batch.numFinishedTasks += 1;
+    if (batch.numFinishedTasks == batch.numTasks) {
+        _batchFinishedCv.notify_all();
+    }
+}
+
+}
@@ -0,0 +1,45 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "macros.h"
+
+
+namespace SynthFilter {
+
+/*
+ * Persistent threads to run the row ranges of a frame conversion in parallel.
+ * The thread calling Run() also works on its own batch, so that a batch always makes progress
+ * even when all workers are busy with the batch of another thread (e.g. input and output conversion at the same time).
+ */
+class WorkerPool {
+public:
+    explicit WorkerPool(int numWorkers);
+
+    DISABLE_COPYING(WorkerPool)
+
+    auto Run(int numTasks, const std::function<void(int)> &taskFunc) -> void;
+    auto GetNumThreads() const -> int { return static_cast<int>(_workers.size()) + 1; }
+
+private:
+    struct Batch {
+        const std::function<void(int)> &taskFunc;
+        int numTasks;
+        int nextTask = 0;
+        int numFinishedTasks = 0;
+    };
+
+    auto WorkerProc(std::stop_token stopToken) -> void;
+    auto ClaimTask(Batch &batch) -> int;
+    auto FinishTask(Batch &batch) -> void;
+
+    std::mutex _mutex;
+    std::condition_variable_any _newBatchCv;
+    std::condition_variable _batchFinishedCv;
+    std::vector<Batch *> _pendingBatches;
+
+    // declared last so that the workers are stopped and joined before the other members are destroyed
+    std::vector<std::jthread> _workers;
+};
+
+}
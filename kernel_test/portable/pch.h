@@ -0,0 +1,52 @@
+#pragma once
+
+/*
+ * Stands in for filter_common/src/pch.h in the GCC and Clang build of kernel_test, with windows_shim.h in place of the Windows SDK and the DirectShow BaseClasses
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <clocale>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cwchar>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <ranges>
+#include <regex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include <cpuid.h>
+#include <immintrin.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <VSHelper4.h>
+#include <VSScript4.h>
+#include <VapourSynth4.h>
+#include <SimpleIni.h>
+#include <VSConstants4.h>
+
+#include "windows_shim.h"
+
+#include "resource.h"
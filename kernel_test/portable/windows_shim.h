@@ -0,0 +1,394 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+/*
+ * The part of the Windows SDK and the DirectShow BaseClasses that the kernels, the frame copies and Environment use, for building kernel_test with GCC or Clang.
+ * The types have the same layout as the originals, so that the media types and the bitmap headers are built the same way as on Windows.
+ * The APIs behave like on a machine without any setting: no module path, an empty registry that cannot be written, and no processor topology.
+ */
+
+using BYTE = uint8_t;
+using WORD = uint16_t;
+using DWORD = uint32_t;
+using LONG = int32_t;
+using ULONG = uint32_t;
+using UINT = unsigned int;
+using BOOL = int;
+using LONGLONG = int64_t;
+using WCHAR = wchar_t;
+using LPCWSTR = const WCHAR *;
+using HRESULT = int32_t;
+using LSTATUS = LONG;
+using REFERENCE_TIME = LONGLONG;
+
+#define TRUE  1
+#define FALSE 0
+
+#define MAX_PATH 260
+
+#define S_OK           static_cast<HRESULT>(0)
+#define E_FAIL         static_cast<HRESULT>(0x80004005)
+#define SUCCEEDED(hr)  (static_cast<HRESULT>(hr) >= 0)
+#define FAILED(hr)     (static_cast<HRESULT>(hr) < 0)
+#define VFW_E_TYPE_NOT_ACCEPTED static_cast<HRESULT>(0x8004022A)
+
+#ifdef _DEBUG
+    #define ASSERT(expr) assert(expr)
+#else
+    #define ASSERT(expr) static_cast<void>(0)
+#endif
+
+constexpr const REFERENCE_TIME UNITS = 10000000;
+
+struct GUID {
+    DWORD Data1;
+    WORD Data2;
+    WORD Data3;
+    std::array<BYTE, 8> Data4;
+
+    constexpr auto operator==(const GUID &other) const -> bool = default;
+};
+using CLSID = GUID;
+
+/*
+ * FourCC subtypes are the FourCC followed by the base GUID {XXXXXXXX-0000-0010-8000-00AA00389B71}
+ */
+class FOURCCMap : public GUID {
+public:
+    constexpr FOURCCMap(DWORD fourCC)
+        : GUID { fourCC, 0x0000, 0x0010, { 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 } } {
+    }
+
+    constexpr FOURCCMap(const GUID *guid)
+        : FOURCCMap(guid->Data1) {
+    }
+
+    constexpr auto GetFOURCC() const -> DWORD { return Data1; }
+};
+
+const GUID MEDIATYPE_Video     = FOURCCMap(0x73646976);
+const GUID FORMAT_VideoInfo    = { 0x05589F80, 0xC356, 0x11CE, { 0xBF, 0x01, 0x00, 0xAA, 0x00, 0x55, 0x59, 0x5A } };
+const GUID FORMAT_VideoInfo2   = { 0xF72A76A0, 0xEB0A, 0x11D0, { 0xAC, 0xE4, 0x00, 0x00, 0xC0, 0xCC, 0x16, 0xBA } };
+const GUID MEDIASUBTYPE_RGB24  = { 0xE436EB7D, 0x524F, 0x11CE, { 0x9F, 0x53, 0x00, 0x20, 0xAF, 0x0B, 0xA7, 0x70 } };
+const GUID MEDIASUBTYPE_RGB32  = { 0xE436EB7E, 0x524F, 0x11CE, { 0x9F, 0x53, 0x00, 0x20, 0xAF, 0x0B, 0xA7, 0x70 } };
+const GUID MEDIASUBTYPE_NV12   = FOURCCMap('21VN');
+const GUID MEDIASUBTYPE_YV12   = FOURCCMap('21VY');
+const GUID MEDIASUBTYPE_IYUV   = FOURCCMap('VUYI');
+const GUID MEDIASUBTYPE_P010   = FOURCCMap('010P');
+const GUID MEDIASUBTYPE_P016   = FOURCCMap('610P');
+const GUID MEDIASUBTYPE_YUY2   = FOURCCMap('2YUY');
+const GUID MEDIASUBTYPE_UYVY   = FOURCCMap('YVYU');
+const GUID MEDIASUBTYPE_P210   = FOURCCMap('012P');
+const GUID MEDIASUBTYPE_P216   = FOURCCMap('612P');
+const GUID MEDIASUBTYPE_AYUV   = FOURCCMap('VUYA');
+
+constexpr const DWORD BI_RGB = 0;
+
+struct RECT {
+    LONG left;
+    LONG top;
+    LONG right;
+    LONG bottom;
+};
+
+inline auto IsRectEmpty(const RECT *rect) -> BOOL {
+    return rect->right <= rect->left || rect->bottom <= rect->top;
+}
+
+struct BITMAPINFOHEADER {
+    DWORD biSize;
+    LONG biWidth;
+    LONG biHeight;
+    WORD biPlanes;
+    WORD biBitCount;
+    DWORD biCompression;
+    DWORD biSizeImage;
+    LONG biXPelsPerMeter;
+    LONG biYPelsPerMeter;
+    DWORD biClrUsed;
+    DWORD biClrImportant;
+};
+
+struct VIDEOINFOHEADER {
+    RECT rcSource;
+    RECT rcTarget;
+    DWORD dwBitRate;
+    DWORD dwBitErrorRate;
+    REFERENCE_TIME AvgTimePerFrame;
+    BITMAPINFOHEADER bmiHeader;
+};
+
+struct VIDEOINFOHEADER2 {
+    RECT rcSource;
+    RECT rcTarget;
+    DWORD dwBitRate;
+    DWORD dwBitErrorRate;
+    REFERENCE_TIME AvgTimePerFrame;
+    DWORD dwInterlaceFlags;
+    DWORD dwCopyProtectFlags;
+    DWORD dwPictAspectRatioX;
+    DWORD dwPictAspectRatioY;
+    DWORD dwControlFlags;
+    DWORD dwReserved2;
+    BITMAPINFOHEADER bmiHeader;
+};
+
+#define AMCONTROL_USED              0x00000001
+#define AMCONTROL_COLORINFO_PRESENT 0x00000080
+
+#define HEADER(pVideoInfo) (&((reinterpret_cast<VIDEOINFOHEADER *>(pVideoInfo))->bmiHeader))
+
+// the bit fields of DXVA_ExtendedFormat are laid out from the least significant bit, the same as MSVC
+struct DXVA_ExtendedFormat {
+    UINT SampleFormat : 8;
+    UINT VideoChromaSubsampling : 4;
+    UINT NominalRange : 3;
+    UINT VideoTransferMatrix : 3;
+    UINT VideoLighting : 4;
+    UINT VideoPrimaries : 5;
+    UINT VideoTransferFunction : 5;
+};
+
+enum {
+    DXVA_NominalRange_Normal = 1,
+    DXVA_NominalRange_Wide   = 2,
+};
+
+enum {
+    DXVA_VideoTransferMatrix_BT709     = 1,
+    DXVA_VideoTransferMatrix_BT601     = 2,
+    DXVA_VideoTransferMatrix_SMPTE240M = 3,
+};
+
+enum {
+    DXVA_VideoPrimaries_BT709         = 2,
+    DXVA_VideoPrimaries_BT470_2_SysM  = 3,
+    DXVA_VideoPrimaries_BT470_2_SysBG = 4,
+    DXVA_VideoPrimaries_SMPTE170M     = 5,
+    DXVA_VideoPrimaries_SMPTE240M     = 6,
+    DXVA_VideoPrimaries_EBU3213       = 7,
+    DXVA_VideoPrimaries_SMPTE_C       = 8,
+};
+
+enum {
+    DXVA_VideoTransFunc_10      = 1,
+    DXVA_VideoTransFunc_18      = 2,
+    DXVA_VideoTransFunc_20      = 3,
+    DXVA_VideoTransFunc_22      = 4,
+    DXVA_VideoTransFunc_22_709  = 5,
+    DXVA_VideoTransFunc_22_240M = 6,
+    DXVA_VideoTransFunc_22_8bit_sRGB = 7,
+    DXVA_VideoTransFunc_28      = 8,
+};
+
+struct AM_MEDIA_TYPE {
+    GUID majortype;
+    GUID subtype;
+    BOOL bFixedSizeSamples;
+    BOOL bTemporalCompression;
+    ULONG lSampleSize;
+    GUID formattype;
+    void *pUnk;
+    ULONG cbFormat;
+    BYTE *pbFormat;
+};
+
+// constants.h only takes the offset of dwSampleFlags
+struct AM_SAMPLE2_PROPERTIES {
+    DWORD cbData;
+    DWORD dwTypeSpecificFlags;
+    DWORD dwSampleFlags;
+    LONG lActual;
+    REFERENCE_TIME tStart;
+    REFERENCE_TIME tStop;
+    DWORD dwStreamId;
+    AM_MEDIA_TYPE *pMediaType;
+    BYTE *pbBuffer;
+    LONG cbBuffer;
+};
+
+// only declared by frameserver.h, whose media type generation is not part of kernel_test
+class CMediaType;
+
+inline auto CheckVideoInfoType(const AM_MEDIA_TYPE *mediaType) -> HRESULT {
+    return mediaType->formattype == FORMAT_VideoInfo && mediaType->cbFormat >= sizeof(VIDEOINFOHEADER) && mediaType->pbFormat != nullptr ? S_OK : VFW_E_TYPE_NOT_ACCEPTED;
+}
+
+inline auto CheckVideoInfo2Type(const AM_MEDIA_TYPE *mediaType) -> HRESULT {
+    return mediaType->formattype == FORMAT_VideoInfo2 && mediaType->cbFormat >= sizeof(VIDEOINFOHEADER2) && mediaType->pbFormat != nullptr ? S_OK : VFW_E_TYPE_NOT_ACCEPTED;
+}
+
+// from the BaseClasses
+inline auto GetBitmapSize(const BITMAPINFOHEADER *header) -> DWORD {
+    const DWORD widthBytes = ((header->biWidth * header->biBitCount + 31) & ~31) / 8;
+    return widthBytes * static_cast<DWORD>(std::abs(header->biHeight));
+}
+
+/*
+ * C runtime
+ */
+
+#define _SH_DENYNO 0x40
+
+inline auto _wsetlocale(int category, const WCHAR *) -> WCHAR * {
+    setlocale(category, "");
+    return nullptr;
+}
+
+inline auto _wfsopen(const std::filesystem::path &filename, const WCHAR *mode, int) -> FILE * {
+    return fopen(filename.c_str(), std::wstring_view(mode) == L"w" ? "w" : "r");
+}
+
+template <typename... Args>
+inline auto fwprintf_s(FILE *stream, const WCHAR *format, Args &&...args) -> int {
+    return fwprintf(stream, format, std::forward<Args>(args)...);
+}
+
+/*
+ * Win32
+ */
+
+#define MB_ICONERROR 0x00000010L
+
+inline auto GetModuleFileNameW(void *, WCHAR *, DWORD) -> DWORD {
+    return 0;
+}
+
+inline auto MessageBoxW(void *, const WCHAR *text, const WCHAR *caption, UINT) -> int {
+    fwprintf(stderr, L"%ls: %ls\n", caption, text);
+    return 0;
+}
+
+inline auto GetCurrentThreadId() -> DWORD {
+    return static_cast<DWORD>(std::hash<std::thread::id>()(std::this_thread::get_id()));
+}
+
+inline auto GetCurrentThread() -> void * {
+    return nullptr;
+}
+
+inline auto SetThreadDescription(void *, const WCHAR *) -> HRESULT {
+    return S_OK;
+}
+
+enum LOGICAL_PROCESSOR_RELATIONSHIP {
+    RelationProcessorCore,
+    RelationNumaNode,
+    RelationCache,
+    RelationProcessorPackage,
+};
+
+enum PROCESSOR_CACHE_TYPE {
+    CacheUnified,
+    CacheInstruction,
+    CacheData,
+    CacheTrace,
+};
+
+struct CACHE_DESCRIPTOR {
+    BYTE Level;
+    BYTE Associativity;
+    WORD LineSize;
+    DWORD Size;
+    PROCESSOR_CACHE_TYPE Type;
+};
+
+struct SYSTEM_LOGICAL_PROCESSOR_INFORMATION {
+    uintptr_t ProcessorMask;
+    LOGICAL_PROCESSOR_RELATIONSHIP Relationship;
+    CACHE_DESCRIPTOR Cache;
+};
+
+inline auto GetLogicalProcessorInformation(SYSTEM_LOGICAL_PROCESSOR_INFORMATION *, DWORD *returnedLength) -> BOOL {
+    *returnedLength = 0;
+    return FALSE;
+}
+
+using HKEY = struct HKEY__ *;
+
+#define HKEY_CURRENT_USER  reinterpret_cast<HKEY>(static_cast<uintptr_t>(0x80000001))
+#define KEY_QUERY_VALUE    0x0001
+#define KEY_SET_VALUE      0x0002
+#define REG_SZ             1
+#define REG_DWORD          4
+#define RRF_RT_REG_SZ      0x00000002
+#define RRF_RT_REG_DWORD   0x00000010
+#define ERROR_SUCCESS      0L
+#define ERROR_FILE_NOT_FOUND  2L
+#define ERROR_ACCESS_DENIED   5L
+
+inline auto RegCreateKeyExW(HKEY key, const WCHAR *, DWORD, WCHAR *, DWORD, DWORD, void *, HKEY *result, DWORD *) -> LSTATUS {
+    *result = key;
+    return ERROR_SUCCESS;
+}
+
+inline auto RegCloseKey(HKEY) -> LSTATUS {
+    return ERROR_SUCCESS;
+}
+
+inline auto RegGetValueW(HKEY, const WCHAR *, const WCHAR *, DWORD, DWORD *, void *, DWORD *) -> LSTATUS {
+    return ERROR_FILE_NOT_FOUND;
+}
+
+inline auto RegSetValueExW(HKEY, const WCHAR *, DWORD, DWORD, const BYTE *, DWORD) -> LSTATUS {
+    return ERROR_ACCESS_DENIED;
+}
+
+#define CP_UTF8 65001
+
+/*
+ * wchar_t is UTF-32 outside Windows. Like the originals, a negative source length includes the terminating null, and a zero destination size returns the required size
+ */
+inline auto WideCharToMultiByte(UINT, DWORD, const WCHAR *src, int srcSize, char *dst, int dstSize, const char *, BOOL *) -> int {
+    const std::wstring_view srcView = srcSize < 0 ? std::wstring_view(src, wcslen(src) + 1) : std::wstring_view(src, srcSize);
+    std::string ret;
+
+    for (const char32_t codePoint : srcView) {
+        if (codePoint < 0x80) {
+            ret += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            ret += static_cast<char>(0xC0 | codePoint >> 6);
+            ret += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            ret += static_cast<char>(0xE0 | codePoint >> 12);
+            ret += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            ret += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            ret += static_cast<char>(0xF0 | codePoint >> 18);
+            ret += static_cast<char>(0x80 | (codePoint >> 12 & 0x3F));
+            ret += static_cast<char>(0x80 | (codePoint >> 6 & 0x3F));
+            ret += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+    }
+
+    if (dstSize == 0) {
+        return static_cast<int>(ret.size());
+    }
+    const int copySize = std::min(static_cast<int>(ret.size()), dstSize);
+    std::copy_n(ret.data(), copySize, dst);
+    return copySize;
+}
+
+inline auto MultiByteToWideChar(UINT, DWORD, const char *src, int srcSize, WCHAR *dst, int dstSize) -> int {
+    const std::string_view srcView = srcSize < 0 ? std::string_view(src, strlen(src) + 1) : std::string_view(src, srcSize);
+    std::wstring ret;
+
+    for (size_t i = 0; i < srcView.size();) {
+        const BYTE leadByte = static_cast<BYTE>(srcView[i]);
+        const int numBytes = leadByte < 0x80 ? 1 : (leadByte < 0xE0 ? 2 : (leadByte < 0xF0 ? 3 : 4));
+        char32_t codePoint = numBytes == 1 ? leadByte : leadByte & (0x7F >> numBytes);
+        for (int b = 1; b < numBytes && i + b < srcView.size(); ++b) {
+            codePoint = codePoint << 6 | (static_cast<BYTE>(srcView[i + b]) & 0x3F);
+        }
+        ret += static_cast<WCHAR>(codePoint);
+        i += numBytes;
+    }
+
+    if (dstSize == 0) {
+        return static_cast<int>(ret.size());
+    }
+    const int copySize = std::min(static_cast<int>(ret.size()), dstSize);
+    std::copy_n(ret.data(), copySize, dst);
+    return copySize;
+}
@@ -0,0 +1,691 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "format.h"
+
+#include "constants.h"
+#include "macros.h"
+#include "test_format.h"
+
+
+namespace SynthFilter {
+
+namespace {
+
+/*
+ * The planar side of each kernel is a frame of AviSynth+ or VapourSynth, both of which align the frame strides to 64 bytes.
+ * The packed side is a media sample, padded to INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT or OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT.
+ */
+constexpr const int FUZZ_FRAME_STRIDE_ALIGNMENT = 64;
+
+constexpr const int FUZZ_MAX_HEIGHT = 6;
+
+// whole frames are tall enough to be split into several stripes and conversion tasks
+constexpr const int FUZZ_MAX_FRAME_HEIGHT = 96;
+
+// most runs use narrow rows to cover the row tails of every vector size, the rest use wide rows for the main loops
+constexpr const int FUZZ_MAX_NARROW_WIDTH = 64;
+constexpr const int FUZZ_MAX_WIDE_WIDTH = 1024;
+
+// the bytes that the kernels must not write are filled with this value before each run
+constexpr const BYTE FUZZ_CANARY = 0xCD;
+
+// size of the canary bytes on the side of each output buffer without the no-access page
+constexpr const int FUZZ_GUARD_SIZE = 64;
+
+/*
+ * Rows of one buffer, mapped right next to a no-access page, so that any read or write beyond the rows on that side faults in every configuration.
+ * With isGuardPageInFront, the page is before the first row in memory. Otherwise it is after the last row, whose end is flush with it as long as the size of the rows
+ * is a multiple of alignment, which is the alignment of the first row in both cases.
+ * Output buffers have guardSize canary bytes on the other side, which are checked for writes after each run together with the bytes between the padded rows.
+ * With isBottomUp, the rows are addressed from the last one in memory with negative stride, like the bottom-up RGB media samples.
+ */
+class GuardedRows {
+public:
+    GuardedRows(int rowSize, int paddedRowSize, int stride, int height, bool isBottomUp, int alignment, bool isGuardPageInFront, int guardSize)
+        : _rowSize(rowSize)
+        , _paddedRowSize(paddedRowSize)
+        , _stride(stride)
+        , _height(height)
+        , _isBottomUp(isBottomUp)
+        , _dataSize(stride * (height - 1) + paddedRowSize) {
+        const size_t pageSize = GetPageSize();
+        const size_t accessibleSize = FFALIGN(static_cast<size_t>(guardSize) + _dataSize + alignment, pageSize);
+        _mappingSize = accessibleSize + pageSize;
+        _mapping = MapPages(_mappingSize);
+
+        if (isGuardPageInFront) {
+            ProtectPage(_mapping);
+            _data = _mapping + pageSize;
+            _frontCanarySize = 0;
+            _backCanarySize = guardSize;
+        } else {
+            BYTE *guardPage = _mapping + accessibleSize;
+            ProtectPage(guardPage);
+            _data = reinterpret_cast<BYTE *>(reinterpret_cast<uintptr_t>(guardPage - _dataSize) & ~static_cast<uintptr_t>(alignment - 1));
+            _frontCanarySize = guardSize;
+            _backCanarySize = static_cast<int>(guardPage - (_data + _dataSize));
+        }
+    }
+
+    ~GuardedRows() {
+        UnmapPages(_mapping, _mappingSize);
+    }
+
+    DISABLE_COPYING(GuardedRows)
+
+    constexpr auto GetData() const -> BYTE * { return _data; }
+    constexpr auto GetFirstRow() const -> BYTE * { return _isBottomUp ? _data + _stride * (_height - 1) : _data; }
+    constexpr auto GetStride() const -> int { return _isBottomUp ? -_stride : _stride; }
+
+    // with sampleBits, the buffer holds 16-bit samples of that many bits
+    auto FillRandom(std::mt19937 &rng, int sampleBits) -> void {
+        std::uniform_int_distribution<int> byteDist(0, UINT8_MAX);
+        std::generate_n(_data, _dataSize, [&]() -> BYTE { return static_cast<BYTE>(byteDist(rng)); });
+
+        if (sampleBits > 0) {
+            uint16_t *samples = reinterpret_cast<uint16_t *>(_data);
+            for (int i = 0; i < _dataSize / static_cast<int>(sizeof(uint16_t)); ++i) {
+                samples[i] &= (1 << sampleBits) - 1;
+            }
+        }
+    }
+
+    auto FillCanary() -> void {
+        memset(_data - _frontCanarySize, FUZZ_CANARY, _frontCanarySize + _dataSize + _backCanarySize);
+    }
+
+    // return the offset from the start of the rows in memory of the first overwritten canary byte
+    auto FindOverwrite() const -> std::optional<int> {
+        for (int i = -_frontCanarySize; i < 0; ++i) {
+            if (_data[i] != FUZZ_CANARY) {
+                return i;
+            }
+        }
+
+        for (int y = 0; y < _height - 1; ++y) {
+            for (int x = _paddedRowSize; x < _stride; ++x) {
+                if (_data[y * _stride + x] != FUZZ_CANARY) {
+                    return y * _stride + x;
+                }
+            }
+        }
+
+        for (int i = _dataSize; i < _dataSize + _backCanarySize; ++i) {
+            if (_data[i] != FUZZ_CANARY) {
+                return i;
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    // the meaningful bytes of each row, which all tiers must agree on
+    auto ExtractRows() const -> std::vector<BYTE> {
+        std::vector<BYTE> ret;
+        ret.reserve(static_cast<size_t>(_rowSize) * _height);
+
+        for (int y = 0; y < _height; ++y) {
+            const BYTE *row = GetFirstRow() + y * GetStride();
+            ret.insert(ret.end(), row, row + _rowSize);
+        }
+
+        return ret;
+    }
+
+private:
+    static auto GetPageSize() -> size_t {
+#ifdef _WIN32
+        SYSTEM_INFO systemInfo;
+        GetSystemInfo(&systemInfo);
+        return systemInfo.dwPageSize;
+#else
+        return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#endif
+    }
+
+    static auto MapPages(size_t size) -> BYTE * {
+#ifdef _WIN32
+        void *pages = VirtualAlloc(nullptr, size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+        if (pages == nullptr) {
+            throw std::bad_alloc();
+        }
+#else
+        void *pages = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pages == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+#endif
+        return static_cast<BYTE *>(pages);
+    }
+
+    static auto ProtectPage(BYTE *page) -> void {
+#ifdef _WIN32
+        DWORD oldProtect;
+        const BOOL isProtected = VirtualProtect(page, GetPageSize(), PAGE_NOACCESS, &oldProtect);
+#else
+        const bool isProtected = mprotect(page, GetPageSize(), PROT_NONE) == 0;
+#endif
+        ASSERT(isProtected);
+        static_cast<void>(isProtected);
+    }
+
+    static auto UnmapPages(BYTE *pages, size_t size) -> void {
+#ifdef _WIN32
+        VirtualFree(pages, 0, MEM_RELEASE);
+#else
+        munmap(pages, size);
+#endif
+    }
+
+    int _rowSize;
+    int _paddedRowSize;
+    int _stride;
+    int _height;
+    bool _isBottomUp;
+    int _dataSize;
+    size_t _mappingSize;
+    BYTE *_mapping;
+    BYTE *_data;
+    int _frontCanarySize;
+    int _backCanarySize;
+};
+
+/*
+ * Bring the random input sample to the form that survives the round trip through the frame:
+ * the least significant bits of the MSB-aligned 16-bit formats and the top 2 bits of Y410 and v210 are zero,
+ * and the alpha of the other 4-component formats is opaque, since the frames have no alpha and the output writes it at maximum.
+ */
+auto CanonicalizeSample(const Format::VideoFormat &videoFormat, BYTE *buffer, int size) -> void {
+    const Format::PixelFormat &pixelFormat = *videoFormat.pixelFormat;
+
+    if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y410 || pixelFormat.srcPlanesLayout == Format::PlanesLayout::ALL_PLANES_BIT_PACKED) {
+        uint32_t *words = reinterpret_cast<uint32_t *>(buffer);
+        for (int i = 0; i < size / static_cast<int>(sizeof(uint32_t)); ++i) {
+            words[i] &= 0x3fffffff;
+        }
+    } else if (videoFormat.videoInfo.format.bitsPerSample == 10) {
+        uint16_t *samples = reinterpret_cast<uint16_t *>(buffer);
+        for (int i = 0; i < size / static_cast<int>(sizeof(uint16_t)); ++i) {
+            samples[i] &= 0xffc0;
+        }
+    } else if (pixelFormat.srcPlanesLayout == Format::PlanesLayout::ALL_PLANES_INTERLEAVED && pixelFormat.componentsPerPixel == 4) {
+        const int componentSize = videoFormat.videoInfo.format.bytesPerSample;
+        for (int i = componentSize * 3; i < size; i += componentSize * 4) {
+            memset(buffer + i, UINT8_MAX, componentSize);
+        }
+    }
+}
+
+}
+
+/**
+ * Differential test of the conversion kernels. In each round, every kernel is run on random width, height, stride padding and row order,
+ * first with the Basic tier, then with every other tier the CPU supports. Each tier must produce the same rows as the Basic tier,
+ * without writing anything beyond the stride padding that the media samples and the frames guarantee, nor the padding between rows.
+ * Reads beyond the padding are left to the address sanitizer of the Debug build.
+ *
+ * Then every pixel format makes round trips of random frames from a media sample through CopyFromInput() and back through CopyToOutput(),
+ * with random stripe heights and temporal flags. Each tier must restore the sample and produce the same frame as the Basic tier.
+ *
+ * Failures are printed with the geometry of the run. The seed is printed too, so that a failing run can be told apart from a clean one.
+ */
+auto Format::RunKernelFuzz(int rounds) -> int {
+    struct FuzzArgs {
+        BYTE *packed;
+        int packedStride;
+        std::array<BYTE *, 3> planes;
+        std::array<int, 3> planeStrides;
+        int packedRowSize;
+        int width;
+        int height;
+        int firstRow;
+    };
+
+    struct FuzzCase {
+        const char *name;
+        bool isPackedOutput;
+
+        // the packed row consists of blocks of blockPixels pixels, each blockSize bytes
+        int blockPixels;
+        int blockSize;
+
+        // bytes per pixel of each plane, 0 for unused planes. The second and the third planes are horizontally subsampled by chromaWidthRatio
+        std::array<int, 3> planePixelSizes;
+        int chromaWidthRatio;
+
+        // random widths are multiples of this
+        int widthMultiple;
+
+        // if non-zero, the 16-bit samples of the planar input are limited to this many bits
+        int planeSampleBits;
+
+        std::function<void(const KernelTable &kernels, const FuzzArgs &args)> run;
+    };
+
+    const YUVToRGBCoefficients yuvToRGBCoeffs = GetYUVToRGBCoefficients({ .colorSpaceInfo { .matrix = VSMatrixCoefficients::VSC_MATRIX_BT709 } });
+
+    const std::array<FuzzCase, 50> fuzzCases { {
+        { "Deinterleave<UV, 8-bit>", false, 1, 2, { 1, 1, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveUVC1Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "Deinterleave<UV, 16-bit>", false, 1, 4, { 2, 2, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveUVC2Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "Deinterleave<UV, 16-bit, right shift>", false, 1, 4, { 2, 2, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveUVC2ShiftFunc(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "Deinterleave<Y416>", false, 1, 8, { 2, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveY416Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "Deinterleave<RGB32>", false, 1, 4, { 1, 1, 1 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveRGBC1Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveRGB<RGB24>", false, 1, 3, { 1, 1, 1 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveRGB24Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveRGB<RGB48>", false, 1, 6, { 2, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveRGB48Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveY410", false, 1, 4, { 2, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveY410Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveYUYV<Y210>", false, 2, 8, { 2, 2, 2 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveY210Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveYUYV<Y216>", false, 2, 8, { 2, 2, 2 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveY216Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveYUYV<YUY2>", false, 2, 4, { 1, 1, 1 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveYUY2Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "DeinterleaveYUYV<UYVY>", false, 2, 4, { 1, 1, 1 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.deinterleaveUYVYFunc(args.packed, args.packedStride, args.planes, args.planeStrides, args.packedRowSize, args.height);
+        } },
+        { "UnpackV210", false, V210_BLOCK_PIXELS, V210_BLOCK_SIZE, { 2, 2, 2 }, 2, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.unpackV210Func(args.packed, args.packedStride, args.planes, args.planeStrides, args.width, args.height);
+        } },
+        { "SwapRedBlue<RGB48>", false, 1, 6, { 6, 0, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.swapRedBlue48Func(args.packed, args.packedStride, args.planes[0], args.planeStrides[0], args.packedRowSize, args.height);
+        } },
+        { "SwapRedBlue<RGB64>", false, 1, 8, { 8, 0, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.swapRedBlue64Func(args.packed, args.packedStride, args.planes[0], args.planeStrides[0], args.packedRowSize, args.height);
+        } },
+        { "BitShiftEach16BitInt<right>", false, 1, 2, { 2, 0, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.rightShiftFunc(args.packed, args.packedStride, args.planes[0], args.planeStrides[0], args.packedRowSize, args.height);
+        } },
+        { "StreamLoadCopy", false, 1, 1, { 1, 0, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.streamLoadCopyFunc(args.packed, args.packedStride, args.planes[0], args.planeStrides[0], args.packedRowSize, args.height);
+        } },
+        { "InterleaveUV<8-bit>", true, 1, 2, { 1, 1, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVC1Func(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveUV<16-bit>", true, 1, 4, { 2, 2, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVC2Func(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveUV<16-bit, left shift>", true, 1, 4, { 2, 2, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVC2ShiftFunc(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveUV<16-bit, left shift, stream>", true, 1, 4, { 2, 2, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVC2ShiftStreamFunc(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveThree<Y416>", true, 1, 8, { 2, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveY416Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveThree<RGB32>", true, 1, 4, { 1, 1, 1 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveRGBC1Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveRGB<RGB24>", true, 1, 3, { 1, 1, 1 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveRGB24Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveRGB<RGB48>", true, 1, 6, { 2, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveRGB48Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveY410", true, 1, 4, { 2, 2, 2 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveY410Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveYUYV<Y210>", true, 2, 8, { 2, 2, 2 }, 2, 2, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveY210Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveYUYV<Y216>", true, 2, 8, { 2, 2, 2 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveY216Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveYUYV<YUY2>", true, 2, 4, { 1, 1, 1 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveYUY2Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "InterleaveYUYV<UYVY>", true, 2, 4, { 1, 1, 1 }, 2, 2, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUYVYFunc({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "PackV210", true, V210_BLOCK_PIXELS, V210_BLOCK_SIZE, { 2, 2, 2 }, 2, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.packV210Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed, args.packedStride, args.width, args.height);
+        } },
+        { "BitShiftEach16BitInt<left>", true, 1, 2, { 2, 0, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.leftShiftFunc(args.planes[0], args.planeStrides[0], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "BitShiftEach16BitInt<left, stream>", true, 1, 2, { 2, 0, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.leftShiftStreamFunc(args.planes[0], args.planeStrides[0], args.packed, args.packedStride, args.packedRowSize, args.height);
+        } },
+        { "ReduceBitDepth<8-bit>", true, 1, 1, { 2, 0, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.reduceBitDepthC1Func(args.planes[0], args.planeStrides[0], args.packed, args.packedStride, args.width, args.height, 10, args.firstRow);
+        } },
+        { "ReduceBitDepth<10-bit>", true, 1, 2, { 2, 0, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.reduceBitDepthC2Func(args.planes[0], args.planeStrides[0], args.packed, args.packedStride, args.width, args.height, 10, args.firstRow);
+        } },
+        { "InterleaveUVReduceBitDepth<8-bit>", true, 1, 2, { 2, 2, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVReduceC1Func(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.width, args.height, 10, args.firstRow);
+        } },
+        { "InterleaveUVReduceBitDepth<10-bit>", true, 1, 4, { 2, 2, 0 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            kernels.interleaveUVReduceC2Func(args.planes[0], args.planes[1], args.planeStrides[0], args.planeStrides[1], args.packed, args.packedStride, args.width, args.height, 10, args.firstRow);
+        } },
+        { "ConvertYUVToRGB32<4:4:4>", true, 1, 4, { 1, 1, 1 }, 1, 1, 0, [&yuvToRGBCoeffs](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            const int firstRow = std::min(args.firstRow, args.height - 1);
+            kernels.yuvToRGB32Func({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed + firstRow * args.packedStride, args.packedStride, args.width, args.height - firstRow, firstRow, 1, yuvToRGBCoeffs);
+        } },
+        { "ConvertYUVToRGB32<4:2:2>", true, 1, 4, { 1, 1, 1 }, 2, 1, 0, [&yuvToRGBCoeffs](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            const int firstRow = std::min(args.firstRow, args.height - 1);
+            kernels.yuvToRGB32SubsampledFunc({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed + firstRow * args.packedStride, args.packedStride, args.width, args.height - firstRow, firstRow, 1, yuvToRGBCoeffs);
+        } },
+        { "ConvertYUVToRGB32<4:2:0>", true, 1, 4, { 1, 1, 1 }, 2, 1, 0, [&yuvToRGBCoeffs](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            const int firstRow = std::min(args.firstRow, args.height - 1);
+            kernels.yuvToRGB32SubsampledFunc({ args.planes[0], args.planes[1], args.planes[2] }, args.planeStrides, args.packed + firstRow * args.packedStride, args.packedStride, args.width, args.height - firstRow, firstRow, 2, yuvToRGBCoeffs);
+        } },
+        { "AverageRows<8-bit>", true, 1, 1, { 1, 1, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.averageRowsC1Func(args.planes[0] + y * args.planeStrides[0], args.planes[1] + y * args.planeStrides[1], args.packed + y * args.packedStride, args.packedRowSize, false);
+            }
+        } },
+        { "AverageRows<8-bit, weighted>", true, 1, 1, { 1, 1, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.averageRowsC1Func(args.planes[0] + y * args.planeStrides[0], args.planes[1] + y * args.planeStrides[1], args.packed + y * args.packedStride, args.packedRowSize, true);
+            }
+        } },
+        { "AverageRows<16-bit>", true, 1, 2, { 2, 2, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.averageRowsC2Func(args.planes[0] + y * args.planeStrides[0], args.planes[1] + y * args.planeStrides[1], args.packed + y * args.packedStride, args.packedRowSize, false);
+            }
+        } },
+        { "AverageRows<16-bit, weighted>", true, 1, 2, { 2, 2, 0 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.averageRowsC2Func(args.planes[0] + y * args.planeStrides[0], args.planes[1] + y * args.planeStrides[1], args.packed + y * args.packedStride, args.packedRowSize, true);
+            }
+        } },
+        { "InterleaveUVResample<8-bit, downsample>", true, 2, 2, { 0, 1, 1 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvDownsampleC1Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, DivideRoundUp(args.width, 2), args.width, 0);
+            }
+        } },
+        { "InterleaveUVResample<16-bit, downsample>", true, 2, 4, { 0, 2, 2 }, 1, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvDownsampleC2Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, DivideRoundUp(args.width, 2), args.width, 0);
+            }
+        } },
+        { "InterleaveUVResample<16-bit, downsample, left shift>", true, 2, 4, { 0, 2, 2 }, 1, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvDownsampleC2Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, DivideRoundUp(args.width, 2), args.width, 6);
+            }
+        } },
+        { "InterleaveUVResample<8-bit, upsample>", true, 1, 2, { 0, 1, 1 }, 2, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvUpsampleC1Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, args.width, DivideRoundUp(args.width, 2), 0);
+            }
+        } },
+        { "InterleaveUVResample<16-bit, upsample>", true, 1, 4, { 0, 2, 2 }, 2, 1, 0, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvUpsampleC2Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, args.width, DivideRoundUp(args.width, 2), 0);
+            }
+        } },
+        { "InterleaveUVResample<16-bit, upsample, left shift>", true, 1, 4, { 0, 2, 2 }, 2, 1, 10, [](const KernelTable &kernels, const FuzzArgs &args) -> void {
+            for (int y = 0; y < args.height; ++y) {
+                kernels.uvUpsampleC2Func(args.planes[1] + y * args.planeStrides[1], args.planes[2] + y * args.planeStrides[2], args.packed + y * args.packedStride, args.width, DivideRoundUp(args.width, 2), 6);
+            }
+        } },
+    } };
+
+    const int supportedIntrinsicType = GetSupportedIntrinsicType();
+    const unsigned int seed = std::random_device()();
+    std::mt19937 rng(seed);
+
+    const auto RandomInt = [&rng](int min, int max) -> int {
+        return std::uniform_int_distribution<int>(min, max)(rng);
+    };
+
+    // minimal padding for most runs, one or two more alignment units for the others
+    const auto RandomStride = [&RandomInt](int paddedRowSize, int alignment) -> int {
+        return paddedRowSize + std::max(RandomInt(-2, 2), 0) * alignment;
+    };
+
+    printf("Start kernel fuzz of %i rounds with seed %u\n", rounds, seed);
+
+    int numFailures = 0;
+    // only the first failure of each kernel and tier is printed
+    std::vector<std::array<bool, INTRINSIC_TYPE_NAMES.size()>> isFailureLogged(fuzzCases.size());
+
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t c = 0; c < fuzzCases.size(); ++c) {
+            const FuzzCase &fuzzCase = fuzzCases[c];
+
+            const int width = RandomInt(1, RandomInt(0, 3) == 0 ? FUZZ_MAX_WIDE_WIDTH : FUZZ_MAX_NARROW_WIDTH) * fuzzCase.widthMultiple;
+            const int height = RandomInt(1, FUZZ_MAX_HEIGHT);
+            const int firstRow = RandomInt(0, 3);
+            const bool isBottomUp = RandomInt(0, 1) == 1;
+
+            const int packedRowSize = DivideRoundUp(width, fuzzCase.blockPixels) * fuzzCase.blockSize;
+            const int packedAlignment = fuzzCase.isPackedOutput ? OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT : INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT;
+            const int packedPaddedRowSize = DivideRoundUp(packedRowSize, packedAlignment) * packedAlignment;
+            GuardedRows packedRows(packedRowSize, packedPaddedRowSize, RandomStride(packedPaddedRowSize, packedAlignment), height, isBottomUp, packedAlignment, RandomInt(0, 1) == 1, fuzzCase.isPackedOutput ? FUZZ_GUARD_SIZE : 0);
+
+            std::array<std::unique_ptr<GuardedRows>, 3> planeRows;
+            for (int p = 0; p < 3; ++p) {
+                if (fuzzCase.planePixelSizes[p] > 0) {
+                    const int planeRowSize = DivideRoundUp(width, p == 0 ? 1 : fuzzCase.chromaWidthRatio) * fuzzCase.planePixelSizes[p];
+                    const int planePaddedRowSize = DivideRoundUp(planeRowSize, FUZZ_FRAME_STRIDE_ALIGNMENT) * FUZZ_FRAME_STRIDE_ALIGNMENT;
+                    planeRows[p] = std::make_unique<GuardedRows>(planeRowSize, planePaddedRowSize, RandomStride(planePaddedRowSize, FUZZ_FRAME_STRIDE_ALIGNMENT), height, false, FUZZ_FRAME_STRIDE_ALIGNMENT, RandomInt(0, 1) == 1, fuzzCase.isPackedOutput ? 0 : FUZZ_GUARD_SIZE);
+                }
+            }
+
+            // the outputs of each run are filled with canary bytes, the inputs stay the same random bytes for all tiers
+            std::vector<GuardedRows *> outputs;
+            if (fuzzCase.isPackedOutput) {
+                outputs.emplace_back(&packedRows);
+            } else {
+                packedRows.FillRandom(rng, 0);
+            }
+            for (const std::unique_ptr<GuardedRows> &rows : planeRows) {
+                if (rows == nullptr) {
+                    continue;
+                }
+
+                if (fuzzCase.isPackedOutput) {
+                    rows->FillRandom(rng, fuzzCase.planeSampleBits);
+                } else {
+                    outputs.emplace_back(rows.get());
+                }
+            }
+
+            FuzzArgs args { .packed = packedRows.GetFirstRow(), .packedStride = packedRows.GetStride(), .planes {}, .planeStrides {}, .packedRowSize = packedRowSize, .width = width, .height = height, .firstRow = firstRow };
+            for (int p = 0; p < 3; ++p) {
+                if (planeRows[p] != nullptr) {
+                    args.planes[p] = planeRows[p]->GetFirstRow();
+                    args.planeStrides[p] = planeRows[p]->GetStride();
+                }
+            }
+
+            std::vector<std::vector<BYTE>> referenceOutputs;
+            for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+                const KernelTable &kernels = _kernelTables[intrinsicType];
+
+                for (GuardedRows *output : outputs) {
+                    output->FillCanary();
+                }
+
+                fuzzCase.run(kernels, args);
+
+                const auto LogFailure = [&](const char *reason, int outputIndex, int offset) -> void {
+                    numFailures += 1;
+                    if (!isFailureLogged[c][intrinsicType]) {
+                        isFailureLogged[c][intrinsicType] = true;
+                        printf("Kernel fuzz failure of %s on %s: %s at output %i offset %i, width %i height %i packed stride %i\n",
+                               fuzzCase.name, INTRINSIC_TYPE_NAMES[intrinsicType], reason, outputIndex, offset, width, height, args.packedStride);
+                    }
+                };
+
+                for (size_t o = 0; o < outputs.size(); ++o) {
+                    if (const std::optional<int> offset = outputs[o]->FindOverwrite()) {
+                        LogFailure("write outside the rows", static_cast<int>(o), *offset);
+                    }
+
+                    std::vector<BYTE> rows = outputs[o]->ExtractRows();
+                    if (intrinsicType == 0) {
+                        referenceOutputs.emplace_back(std::move(rows));
+                    } else if (const auto [referenceIter, rowsIter] = std::ranges::mismatch(referenceOutputs[o], rows); rowsIter != rows.end()) {
+                        LogFailure("mismatch with Basic", static_cast<int>(o), static_cast<int>(rowsIter - rows.begin()));
+                    }
+                }
+            }
+        }
+    }
+
+    // rows of each plane of a media sample, located by its buffer plan
+    struct SamplePlane {
+        ptrdiff_t offset;
+        int stride;
+        int rowSize;
+        int height;
+    };
+
+    const auto GetSamplePlanes = [](const VideoFormat &videoFormat, const VideoFormat::BufferPlan &plan) -> std::vector<SamplePlane> {
+        const PixelFormat &pixelFormat = *videoFormat.pixelFormat;
+        const int width = videoFormat.videoInfo.width;
+        const int height = videoFormat.videoInfo.height;
+
+        // same row sizes as CopyFromInput() and CopyToOutput()
+        int mainPlaneRowSize = width * videoFormat.videoInfo.format.bytesPerSample;
+        if (pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
+            mainPlaneRowSize *= pixelFormat.componentsPerPixel;
+            if (pixelFormat.mediaSubtype == MEDIASUBTYPE_Y410) {
+                mainPlaneRowSize /= 2;
+            }
+        } else if (pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED) {
+            mainPlaneRowSize = DivideRoundUp(width, V210_BLOCK_PIXELS) * V210_BLOCK_SIZE;
+        }
+
+        std::vector<SamplePlane> ret { { plan.planeOffsets[0], plan.mainPlaneStride, mainPlaneRowSize, height } };
+        if (pixelFormat.srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED) {
+            ret.push_back({ plan.planeOffsets[1], plan.uvPlaneStride, mainPlaneRowSize * 2 / pixelFormat.subsampleWidthRatio, height / pixelFormat.subsampleHeightRatio });
+        } else if (pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE) {
+            for (int p = 1; p < 3; ++p) {
+                ret.push_back({ plan.planeOffsets[p], plan.uvPlaneStride, mainPlaneRowSize / pixelFormat.subsampleWidthRatio, height / pixelFormat.subsampleHeightRatio });
+            }
+        }
+
+        return ret;
+    };
+
+    // the media samples are padded for the highest tier, which also suits the others
+    const int sampleStrideAlignment = std::max(INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT, OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT);
+    std::vector<std::array<bool, INTRINSIC_TYPE_NAMES.size()>> isCopyFailureLogged(PIXEL_FORMATS.size());
+
+    for (int round = 0; round < rounds; ++round) {
+        for (size_t f = 0; f < PIXEL_FORMATS.size(); ++f) {
+            const PixelFormat &pixelFormat = PIXEL_FORMATS[f];
+
+            // whole blocks of v210 and whole subsampled pixels, as in the media types that the filter accepts
+            const int subsampleWidthRatio = std::max(pixelFormat.subsampleWidthRatio, 1);
+            const int subsampleHeightRatio = std::max(pixelFormat.subsampleHeightRatio, 1);
+            const int widthMultiple = pixelFormat.srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED ? V210_BLOCK_PIXELS : subsampleWidthRatio;
+            const int width = RandomInt(1, (RandomInt(0, 3) == 0 ? FUZZ_MAX_WIDE_WIDTH : FUZZ_MAX_NARROW_WIDTH) / widthMultiple) * widthMultiple;
+            const int height = RandomInt(1, FUZZ_MAX_FRAME_HEIGHT / subsampleHeightRatio) * subsampleHeightRatio;
+            const int strideWidth = FFALIGN(width, sampleStrideAlignment) + std::max(RandomInt(-2, 1), 0) * sampleStrideAlignment;
+
+            VideoFormat videoFormat = CreateTestVideoFormat(pixelFormat, width, height, strideWidth, RandomInt(0, 1) == 1);
+            const int sampleSize = static_cast<int>(videoFormat.bmi.biSizeImage);
+
+            GuardedRows inputSample(sampleSize, sampleSize, sampleSize, 1, false, sampleStrideAlignment, RandomInt(0, 1) == 1, 0);
+            inputSample.FillRandom(rng, 0);
+            CanonicalizeSample(videoFormat, inputSample.GetData(), sampleSize);
+            GuardedRows outputSample(sampleSize, sampleSize, sampleSize, 1, false, sampleStrideAlignment, RandomInt(0, 1) == 1, FUZZ_GUARD_SIZE);
+
+            // the frame of VapourSynth, whose planes are subsampled by the frame format
+            const VSVideoFormat &frameFormat = videoFormat.videoInfo.format;
+            std::array<std::unique_ptr<GuardedRows>, 3> framePlanes;
+            std::array<BYTE *, 3> frameSlices {};
+            std::array<int, 3> frameStrides {};
+            for (int p = 0; p < frameFormat.numPlanes; ++p) {
+                const int planeRowSize = (p == 0 ? width : width >> frameFormat.subSamplingW) * frameFormat.bytesPerSample;
+                const int planeHeight = p == 0 ? height : height >> frameFormat.subSamplingH;
+                const int planePaddedRowSize = FFALIGN(planeRowSize, FUZZ_FRAME_STRIDE_ALIGNMENT);
+                framePlanes[p] = std::make_unique<GuardedRows>(planeRowSize, planePaddedRowSize, RandomStride(planePaddedRowSize, FUZZ_FRAME_STRIDE_ALIGNMENT), planeHeight, false, FUZZ_FRAME_STRIDE_ALIGNMENT, RandomInt(0, 1) == 1, FUZZ_GUARD_SIZE);
+                frameSlices[p] = framePlanes[p]->GetFirstRow();
+                frameStrides[p] = framePlanes[p]->GetStride();
+            }
+
+            std::vector<std::vector<BYTE>> referenceFrame;
+            for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+                const auto LogFailure = [&](const char *reason, int planeIndex, ptrdiff_t offset) -> void {
+                    numFailures += 1;
+                    if (!isCopyFailureLogged[f][intrinsicType]) {
+                        isCopyFailureLogged[f][intrinsicType] = true;
+                        printf("Copy fuzz failure of %ls on %s: %s at plane %i offset %td, width %i height %i stride width %i, bottom-up %i stripe %i temporal flags %i %i\n",
+                               pixelFormat.name, INTRINSIC_TYPE_NAMES[intrinsicType], reason, planeIndex, offset, width, height, strideWidth, videoFormat.bmi.biHeight > 0 && videoFormat.bmi.biCompression == BI_RGB,
+                               videoFormat.tunedStripeSize.value_or(INT_MIN), videoFormat.inputBufferTemporalFlags, videoFormat.outputBufferTemporalFlags);
+                    }
+                };
+
+                videoFormat.kernels = &_kernelTables[intrinsicType];
+                if (const int stripeIndex = RandomInt(0, static_cast<int>(AUTOTUNE_STRIPE_SIZES.size())); stripeIndex < static_cast<int>(AUTOTUNE_STRIPE_SIZES.size())) {
+                    videoFormat.tunedStripeSize = AUTOTUNE_STRIPE_SIZES[stripeIndex];
+                } else {
+                    videoFormat.tunedStripeSize = std::nullopt;
+                }
+                // as if the sample buffers were write-combined, which takes the streaming loads and stores
+                videoFormat.inputBufferTemporalFlags = RandomInt(0, 1) == 1 ? 0b11 : 0;
+                videoFormat.outputBufferTemporalFlags = (videoFormat.outputBufferTemporalFlags & 1) != 0 && RandomInt(0, 1) == 1 ? 0b111 : videoFormat.outputBufferTemporalFlags & 1;
+
+                for (const std::unique_ptr<GuardedRows> &plane : framePlanes) {
+                    if (plane != nullptr) {
+                        plane->FillCanary();
+                    }
+                }
+                CopyFromInput(videoFormat, inputSample.GetData(), frameSlices, frameStrides, width, height);
+
+                for (int p = 0; p < frameFormat.numPlanes; ++p) {
+                    if (const std::optional<int> offset = framePlanes[p]->FindOverwrite()) {
+                        LogFailure("frame write outside the rows", p, *offset);
+                    }
+
+                    std::vector<BYTE> rows = framePlanes[p]->ExtractRows();
+                    if (intrinsicType == 0) {
+                        referenceFrame.emplace_back(std::move(rows));
+                    } else if (const auto [referenceIter, rowsIter] = std::ranges::mismatch(referenceFrame[p], rows); rowsIter != rows.end()) {
+                        LogFailure("frame mismatch with Basic", p, rowsIter - rows.begin());
+                    }
+                }
+
+                outputSample.FillCanary();
+                CopyToOutput(videoFormat, { frameSlices[0], frameSlices[1], frameSlices[2] }, frameStrides, outputSample.GetData(), width, height, videoFormat.videoInfo);
+
+                if (const std::optional<int> offset = outputSample.FindOverwrite()) {
+                    LogFailure("sample write outside the buffer", -1, *offset);
+                }
+
+                const std::vector<SamplePlane> inputPlanes = GetSamplePlanes(videoFormat, videoFormat.inputPlan);
+                const std::vector<SamplePlane> outputPlanes = GetSamplePlanes(videoFormat, videoFormat.outputPlan);
+                for (size_t p = 0; p < inputPlanes.size(); ++p) {
+                    for (int y = 0; y < inputPlanes[p].height; ++y) {
+                        const BYTE *inputRow = inputSample.GetData() + inputPlanes[p].offset + static_cast<ptrdiff_t>(y) * inputPlanes[p].stride;
+                        const BYTE *outputRow = outputSample.GetData() + outputPlanes[p].offset + static_cast<ptrdiff_t>(y) * outputPlanes[p].stride;
+
+                        if (const auto [inputIter, outputIter] = std::mismatch(inputRow, inputRow + inputPlanes[p].rowSize, outputRow); inputIter != inputRow + inputPlanes[p].rowSize) {
+                            LogFailure("sample mismatch after the round trip", static_cast<int>(p), static_cast<ptrdiff_t>(y) * inputPlanes[p].stride + (inputIter - inputRow));
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    printf("Kernel fuzz finished with %i failures\n", numFailures);
+    return numFailures;
+}
+
+}
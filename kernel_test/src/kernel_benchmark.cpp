@@ -0,0 +1,256 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "format.h"
+
+#include "constants.h"
+#include "macros.h"
+#include "test_format.h"
+
+
+namespace SynthFilter {
+
+namespace {
+
+struct BenchmarkResolution {
+    const char *name;
+    int width;
+    int height;
+};
+
+// every width is a multiple of the 6 pixels of a v210 block
+constexpr const std::array<BenchmarkResolution, 4> BENCHMARK_RESOLUTIONS { {
+    { .name = "SD", .width = 720, .height = 480 },
+    { .name = "1080p", .width = 1920, .height = 1080 },
+    { .name = "4K", .width = 3840, .height = 2160 },
+    { .name = "8K", .width = 7680, .height = 4320 },
+} };
+
+}
+
+/**
+ * Time each kernel of the sample conversion, as well as the whole CopyFromInput() and CopyToOutput() of the common input formats,
+ * for the frame sizes from SD to 8K on every tier the CPU supports. The results are printed and written to outputPath as JSON.
+ *
+ * The bandwidth counts both the bytes read and written. The cycles are from the time stamp counter, which ticks at the nominal frequency.
+ */
+auto Format::RunBenchmark(const std::filesystem::path &outputPath) -> bool {
+    struct KernelCase {
+        const char *name;
+
+        // bytes per pixel of the packed side, and of all planes of the planar side, where the subsampled planes count by their share
+        double packedPixelSize;
+        double planarPixelSize;
+
+        // bytes per pixel of the largest plane, which every plane is allocated for
+        int planePixelSize;
+
+        std::function<void(const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height)> run;
+    };
+
+    const std::array<KernelCase, 37> kernelCases { {
+        { "Deinterleave<UV, 8-bit>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveUVC1Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 2, height);
+        } },
+        { "Deinterleave<UV, 16-bit>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveUVC2Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "Deinterleave<UV, 16-bit, right shift>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveUVC2ShiftFunc(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "Deinterleave<Y416>", 8, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveY416Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 8, height);
+        } },
+        { "Deinterleave<RGB32>", 4, 3, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveRGBC1Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "DeinterleaveRGB<RGB24>", 3, 3, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveRGB24Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 3, height);
+        } },
+        { "DeinterleaveRGB<RGB48>", 6, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveRGB48Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 6, height);
+        } },
+        { "DeinterleaveY410", 4, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveY410Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "DeinterleaveYUYV<YUY2>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveYUY2Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 2, height);
+        } },
+        { "DeinterleaveYUYV<UYVY>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveUYVYFunc(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 2, height);
+        } },
+        { "DeinterleaveYUYV<Y210>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveY210Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "DeinterleaveYUYV<Y216>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.deinterleaveY216Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width * 4, height);
+        } },
+        { "UnpackV210", static_cast<double>(V210_BLOCK_SIZE) / V210_BLOCK_PIXELS, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.unpackV210Func(packed, packedStride, planes, { planeStride, planeStride, planeStride }, width, height);
+        } },
+        { "InterleaveUV<8-bit>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVC1Func(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width * 2, height);
+        } },
+        { "InterleaveUV<16-bit>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVC2Func(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveUV<16-bit, left shift>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVC2ShiftFunc(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveUV<16-bit, left shift, stream>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVC2ShiftStreamFunc(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveThree<Y416>", 8, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveY416Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 8, height);
+        } },
+        { "InterleaveThree<RGB32>", 4, 3, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveRGBC1Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveRGB<RGB24>", 3, 3, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveRGB24Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 3, height);
+        } },
+        { "InterleaveRGB<RGB48>", 6, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveRGB48Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 6, height);
+        } },
+        { "InterleaveY410", 4, 6, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveY410Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveYUYV<YUY2>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveYUY2Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 2, height);
+        } },
+        { "InterleaveYUYV<UYVY>", 2, 2, 1, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUYVYFunc({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 2, height);
+        } },
+        { "InterleaveYUYV<Y210>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveY210Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 4, height);
+        } },
+        { "InterleaveYUYV<Y216>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveY216Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width * 4, height);
+        } },
+        { "PackV210", static_cast<double>(V210_BLOCK_SIZE) / V210_BLOCK_PIXELS, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.packV210Func({ planes[0], planes[1], planes[2] }, { planeStride, planeStride, planeStride }, packed, packedStride, width, height);
+        } },
+        // the planar side of SwapRedBlue is the packed RGB destination
+        { "SwapRedBlue<RGB48>", 6, 6, 6, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.swapRedBlue48Func(packed, packedStride, planes[0], planeStride, width * 6, height);
+        } },
+        { "SwapRedBlue<RGB64>", 8, 8, 8, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.swapRedBlue64Func(packed, packedStride, planes[0], planeStride, width * 8, height);
+        } },
+        { "ReduceBitDepth<8-bit>", 1, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.reduceBitDepthC1Func(planes[0], planeStride, packed, packedStride, width, height, 16, 0);
+        } },
+        { "ReduceBitDepth<10-bit>", 2, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.reduceBitDepthC2Func(planes[0], planeStride, packed, packedStride, width, height, 16, 0);
+        } },
+        { "InterleaveUVReduceBitDepth<8-bit>", 2, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVReduceC1Func(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width, height, 16, 0);
+        } },
+        { "InterleaveUVReduceBitDepth<10-bit>", 4, 4, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.interleaveUVReduceC2Func(planes[0], planes[1], planeStride, planeStride, packed, packedStride, width, height, 16, 0);
+        } },
+        { "BitShiftEach16BitInt<right>", 2, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.rightShiftFunc(packed, packedStride, planes[0], planeStride, width * 2, height);
+        } },
+        { "BitShiftEach16BitInt<left>", 2, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.leftShiftFunc(planes[0], planeStride, packed, packedStride, width * 2, height);
+        } },
+        { "BitShiftEach16BitInt<left, stream>", 2, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.leftShiftStreamFunc(planes[0], planeStride, packed, packedStride, width * 2, height);
+        } },
+        { "StreamLoadCopy", 2, 2, 2, [](const KernelTable &kernels, BYTE *packed, int packedStride, const std::array<BYTE *, 3> &planes, int planeStride, int width, int height) -> void {
+            kernels.streamLoadCopyFunc(packed, packedStride, planes[0], planeStride, width * 2, height);
+        } },
+    } };
+
+    // the whole frame copies run through the stripes and the worker pool just like the actual samples
+    const std::array frameCopySubtypes { &MEDIASUBTYPE_NV12, &MEDIASUBTYPE_P010 };
+
+    std::ofstream outputFile(outputPath);
+    if (!outputFile) {
+        printf("Unable to open the benchmark output file: %s\n", outputPath.string().c_str());
+        return false;
+    }
+
+    const int supportedIntrinsicType = GetSupportedIntrinsicType();
+    std::vector<std::string> results;
+
+    const auto AddResult = [&results](const char *name, int intrinsicType, const BenchmarkResolution &resolution, const BenchmarkStats &stats, double bytesPerRun) -> void {
+        const double gigabytesPerSecond = bytesPerRun / stats.meanMicroseconds / 1000;
+        const double cyclesPerPixel = stats.ticksPerRun / (static_cast<double>(resolution.width) * resolution.height);
+
+        printf("Benchmark %-42s %-7s %-5s: %8.1f us +- %6.1f, %6.2f GB/s, %6.3f cycles per pixel\n",
+               name, INTRINSIC_TYPE_NAMES[intrinsicType], resolution.name, stats.meanMicroseconds, stats.stdDevMicroseconds, gigabytesPerSecond, cyclesPerPixel);
+        results.emplace_back(std::format(R"({{ "name": "{}", "tier": "{}", "resolution": "{}", "width": {}, "height": {}, "meanMicroseconds": {:.2f}, "stdDevMicroseconds": {:.2f}, "gigabytesPerSecond": {:.3f}, "cyclesPerPixel": {:.4f} }})",
+                                         name, INTRINSIC_TYPE_NAMES[intrinsicType], resolution.name, resolution.width, resolution.height, stats.meanMicroseconds, stats.stdDevMicroseconds, gigabytesPerSecond, cyclesPerPixel));
+    };
+
+    for (int intrinsicType = 0; intrinsicType <= supportedIntrinsicType; ++intrinsicType) {
+        const KernelTable &kernels = _kernelTables[intrinsicType];
+
+        for (const BenchmarkResolution &resolution : BENCHMARK_RESOLUTIONS) {
+            try {
+                std::vector<BYTE> packedStorage;
+                std::array<std::vector<BYTE>, 3> planeStorages;
+
+                for (const KernelCase &kernelCase : kernelCases) {
+                    const int packedStride = GetBenchmarkStride(static_cast<int>(std::ceil(resolution.width * kernelCase.packedPixelSize)));
+                    const int planeStride = GetBenchmarkStride(resolution.width * kernelCase.planePixelSize);
+
+                    BYTE *packed = AllocateBenchmarkBuffer(packedStorage, static_cast<size_t>(packedStride) * (resolution.height + 1));
+                    std::array<BYTE *, 3> planes {};
+                    for (size_t p = 0; p < planes.size(); ++p) {
+                        planes[p] = AllocateBenchmarkBuffer(planeStorages[p], static_cast<size_t>(planeStride) * (resolution.height + 1));
+                    }
+
+                    const BenchmarkStats stats = MeasureRuns([&]() -> void {
+                        kernelCase.run(kernels, packed, packedStride, planes, planeStride, resolution.width, resolution.height);
+                    });
+                    AddResult(kernelCase.name, intrinsicType, resolution, stats,
+                              static_cast<double>(resolution.width) * resolution.height * (kernelCase.packedPixelSize + kernelCase.planarPixelSize));
+                }
+
+                for (const GUID *subtype : frameCopySubtypes) {
+                    const PixelFormat *pixelFormat = LookupMediaSubtype(*subtype);
+
+                    // the media sample strides are padded by the upstream and downstream filters, which the aligned loads and stores of the kernels rely on
+                    const int strideWidth = FFALIGN(resolution.width, std::max(INPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT, OUTPUT_MEDIA_SAMPLE_STRIDE_ALIGNMENT));
+                    VideoFormat videoFormat = CreateTestVideoFormat(*pixelFormat, resolution.width, resolution.height, strideWidth, false);
+                    videoFormat.kernels = &kernels;
+                    const FrameCopyBuffers buffers = AllocateFrameCopyBuffers(videoFormat, packedStorage, planeStorages);
+
+                    const std::string copyFromInputName = std::format("CopyFromInput<{}>", ConvertWideToUtf8(pixelFormat->name));
+                    AddResult(copyFromInputName.c_str(), intrinsicType, resolution, MeasureCopyFromInput(videoFormat, buffers), videoFormat.bmi.biSizeImage * 2.0);
+
+                    const std::string copyToOutputName = std::format("CopyToOutput<{}>", ConvertWideToUtf8(pixelFormat->name));
+                    AddResult(copyToOutputName.c_str(), intrinsicType, resolution, MeasureCopyToOutput(videoFormat, buffers), videoFormat.bmi.biSizeImage * 2.0);
+                }
+            } catch (const std::bad_alloc &) {
+                // the 8K buffers may not fit in the address space of the 32-bit build
+                printf("Benchmark skips the %s resolution due to insufficient memory\n", resolution.name);
+            }
+        }
+    }
+
+    std::string joinedResults;
+    for (const std::string &result : results) {
+        if (!joinedResults.empty()) {
+            joinedResults += ",\n    ";
+        }
+        joinedResults += result;
+    }
+
+    outputFile << std::format(R"({{ "version": "{}", "iterations": {}, "activeTier": "{}", "results": [
+    {}
+] }}
+)", FILTER_VERSION_STRING, BENCHMARK_ITERATIONS, INTRINSIC_TYPE_NAMES[supportedIntrinsicType], joinedResults);
+    outputFile.close();
+    if (!outputFile) {
+        printf("Unable to write the benchmark output file: %s\n", outputPath.string().c_str());
+        return false;
+    }
+
+    printf("Benchmark results are written to %s\n", outputPath.string().c_str());
+    return true;
+}
+
+}
@@ -0,0 +1,48 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "environment.h"
+#include "format.h"
+
+
+namespace {
+
+constexpr const int DEFAULT_FUZZ_ROUNDS = 100;
+
+auto IsEqualIgnoreCase(std::string_view str1, std::string_view str2) -> bool {
+    return std::ranges::equal(str1, str2, [](char ch1, char ch2) -> bool {
+        return std::tolower(static_cast<unsigned char>(ch1)) == std::tolower(static_cast<unsigned char>(ch2));
+    });
+}
+
+}
+
+/*
+ * Usage: kernel_test [rounds]
+ *        kernel_test benchmark <output JSON path>
+ * The first form checks every supported SIMD tier against the Basic tier, and exits with failure if any of them mismatches.
+ * The second form times the kernels and the frame copies on every supported tier instead.
+ */
+auto main(int argc, char *argv[]) -> int {
+    const bool isBenchmark = argc > 1 && IsEqualIgnoreCase(argv[1], "benchmark");
+    if (isBenchmark && argc < 3) {
+        printf("Missing the benchmark output path\n");
+        return EXIT_FAILURE;
+    }
+
+    // Format reads the supported SIMD tier and the kernel plans from the environment
+    SynthFilter::Environment::Create();
+    SynthFilter::Format::Initialize();
+
+    bool isSuccessful;
+    if (isBenchmark) {
+        isSuccessful = SynthFilter::Format::RunBenchmark(argv[2]);
+    } else {
+        const int rounds = argc > 1 ? std::max(std::atoi(argv[1]), 1) : DEFAULT_FUZZ_ROUNDS;
+        isSuccessful = SynthFilter::Format::RunKernelFuzz(rounds) == 0;
+    }
+
+    SynthFilter::Format::Uninitialize();
+    SynthFilter::Environment::Destroy();
+
+    return isSuccessful ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,55 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#include "test_format.h"
+
+#include "constants.h"
+
+
+namespace SynthFilter {
+
+auto CreateTestVideoFormat(const Format::PixelFormat &pixelFormat, int width, int height, int strideWidth, bool isBottomUp) -> Format::VideoFormat {
+    // uncompressed formats (such as RGB32) have different GUIDs than their FourCC, and are the only ones that can be bottom-up
+    const FOURCCMap fourCC(&pixelFormat.mediaSubtype);
+    const bool isBitmapRGB = fourCC != pixelFormat.mediaSubtype;
+
+    Format::VideoFormat ret {
+        .pixelFormat = &pixelFormat,
+        .videoInfo = {
+            .fpsNum = UNITS,
+            .fpsDen = DEFAULT_AVG_TIME_PER_FRAME,
+            .width = width,
+            .height = height,
+            .numFrames = NUM_FRAMES_FOR_INFINITE_STREAM,
+        },
+        .bmi = {
+            .biSize = sizeof(BITMAPINFOHEADER),
+            .biWidth = strideWidth,
+            .biHeight = isBitmapRGB && !isBottomUp ? -height : height,
+            .biPlanes = 1,
+            .biBitCount = pixelFormat.bitCount,
+            .biCompression = isBitmapRGB ? BI_RGB : fourCC.GetFOURCC(),
+        },
+    };
+    ret.bmi.biSizeImage = Format::GetBitmapImageSize(ret.bmi);
+
+    // reverse of VS_MAKE_VIDEO_ID()
+    const uint32_t formatId = static_cast<uint32_t>(pixelFormat.frameServerFormatId);
+    VSVideoFormat &frameFormat = ret.videoInfo.format;
+    frameFormat.colorFamily = static_cast<int>(formatId >> 28 & 0xF);
+    frameFormat.sampleType = static_cast<int>(formatId >> 24 & 0xF);
+    frameFormat.bitsPerSample = static_cast<int>(formatId >> 16 & 0xFF);
+    frameFormat.bytesPerSample = frameFormat.bitsPerSample <= 8 ? 1 : (frameFormat.bitsPerSample <= 16 ? 2 : 4);
+    frameFormat.subSamplingW = static_cast<int>(formatId >> 8 & 0xFF);
+    frameFormat.subSamplingH = static_cast<int>(formatId & 0xFF);
+    frameFormat.numPlanes = frameFormat.colorFamily == cfGray ? 1 : 3;
+
+    ret.outputBufferTemporalFlags = pixelFormat.srcPlanesLayout == Format::PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && frameFormat.bitsPerSample == 10;
+
+    const bool isInverted = ret.bmi.biCompression == BI_RGB && ret.bmi.biHeight > 0;
+    ret.inputPlan = Format::GetBufferPlan(ret, 0, 0, frameFormat.bytesPerSample, isInverted);
+    ret.outputPlan = ret.inputPlan;
+
+    return ret;
+}
+
+}
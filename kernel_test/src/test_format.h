@@ -0,0 +1,17 @@
+// License: https://github.com/CrendKing/avisynth_filter/blob/master/LICENSE
+
+#pragma once
+
+#include "format.h"
+
+
+namespace SynthFilter {
+
+/*
+ * VideoFormat of a media sample of the pixel format, the same as GetVideoFormat() of the VapourSynth variant works out from the media type,
+ * except that the format of the frames is decoded from the format ID instead of queried from the core, so that no frame server is needed.
+ * strideWidth is the biWidth of the media type, which is the stride in pixels. The kernels are left for the caller to pick.
+ */
+auto CreateTestVideoFormat(const Format::PixelFormat &pixelFormat, int width, int height, int strideWidth, bool isBottomUp) -> Format::VideoFormat;
+
+}
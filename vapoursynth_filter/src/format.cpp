@@ -10,7 +10,7 @@
 namespace SynthFilter {
 
 // for each group of formats with the same format ID, they should appear with the most preferred -> least preferred order
-// VapourSynth does not support any interleaved format such as YUY2 or RGB
+// VapourSynth does not support any interleaved format such as YUY2 or RGB, so they are split into planes, e.g. YUY2 and UYVY to YUV422P8, RGB24 and RGB32 to planar RGB24
 const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     // 4:2:0
     { .name = L"NV12",  .mediaSubtype = MEDIASUBTYPE_NV12,  .frameServerFormatId = pfYUV420P8,  .bitCount = 12, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 2,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_NV12 },
@@ -24,18 +24,72 @@ const std::vector<Format::PixelFormat> Format::PIXEL_FORMATS {
     { .name = L"P016",  .mediaSubtype = MEDIASUBTYPE_P016,  .frameServerFormatId = pfYUV420P16, .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 2,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P016 },
 
     // 4:2:2
+    { .name = L"YUY2",  .mediaSubtype = MEDIASUBTYPE_YUY2,  .frameServerFormatId = pfYUV422P8,  .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_YUY2 },
+    { .name = L"UYVY",  .mediaSubtype = MEDIASUBTYPE_UYVY,  .frameServerFormatId = pfYUV422P8,  .bitCount = 16, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_UYVY },
     { .name = L"P210",  .mediaSubtype = MEDIASUBTYPE_P210,  .frameServerFormatId = pfYUV422P10, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P210 },
     { .name = L"P216",  .mediaSubtype = MEDIASUBTYPE_P216,  .frameServerFormatId = pfYUV422P16, .bitCount = 32, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P216 },
+    // Y210 and Y216 interleave all planes in the Y0 U0 Y1 V0 order. Like P210, Y210 has the samples aligned to the most significant bits
+    { .name = L"Y210",  .mediaSubtype = MEDIASUBTYPE_Y210,  .frameServerFormatId = pfYUV422P10, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y210 },
+    { .name = L"Y216",  .mediaSubtype = MEDIASUBTYPE_Y216,  .frameServerFormatId = pfYUV422P16, .bitCount = 32, .componentsPerPixel = 2, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y216 },
+    // v210 packs 6 pixels in every 16 bytes. Its bitCount is nominal, the stride comes from GetV210Stride()
+    { .name = L"v210",  .mediaSubtype = MEDIASUBTYPE_V210,  .frameServerFormatId = pfYUV422P10, .bitCount = 20, .componentsPerPixel = 1, .subsampleWidthRatio = 2,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_BIT_PACKED,         .resourceId = IDC_INPUT_FORMAT_V210 },
 
     // 4:4:4
     { .name = L"YV24",  .mediaSubtype = MEDIASUBTYPE_YV24,  .frameServerFormatId = pfYUV444P8,  .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_SEPARATE,           .resourceId = IDC_INPUT_FORMAT_YV24 },
-    // Y41x from DirectShow contains alpha plane, which is used during video playback, therefore we ignore it and feed frame server YUV444
+    // Y41x and AYUV from DirectShow contain alpha plane, which is used during video playback, therefore we ignore it and feed frame server YUV444
     { .name = L"Y410",  .mediaSubtype = MEDIASUBTYPE_Y410,  .frameServerFormatId = pfYUV444P10, .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y410 },
     { .name = L"Y416",  .mediaSubtype = MEDIASUBTYPE_Y416,  .frameServerFormatId = pfYUV444P16, .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_Y416 },
+    { .name = L"AYUV",  .mediaSubtype = MEDIASUBTYPE_AYUV,  .frameServerFormatId = pfYUV444P8,  .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_AYUV },
+    // semi-planar 4:4:4 formats interleave U and V in a plane twice as wide as Y. Like P010, P410 has the samples aligned to the most significant bits
+    { .name = L"NV24",  .mediaSubtype = MEDIASUBTYPE_NV24,  .frameServerFormatId = pfYUV444P8,  .bitCount = 24, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_NV24 },
+    { .name = L"P410",  .mediaSubtype = MEDIASUBTYPE_P410,  .frameServerFormatId = pfYUV444P10, .bitCount = 48, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P410 },
+    { .name = L"P416",  .mediaSubtype = MEDIASUBTYPE_P416,  .frameServerFormatId = pfYUV444P16, .bitCount = 48, .componentsPerPixel = 1, .subsampleWidthRatio = 1,  .subsampleHeightRatio = 1,  .srcPlanesLayout = PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED, .resourceId = IDC_INPUT_FORMAT_P416 },
 
     { .name = L"RGB32", .mediaSubtype = MEDIASUBTYPE_RGB32, .frameServerFormatId = pfRGB24,     .bitCount = 32, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB32 },
+    { .name = L"RGB24", .mediaSubtype = MEDIASUBTYPE_RGB24, .frameServerFormatId = pfRGB24,     .bitCount = 24, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB24 },
+    // RGB48 and RGB64 are in R-G-B pixel order, the reverse of RGB24 and RGB32. The planes are reversed during the copy, so that all RGB formats produce the same planes
+    { .name = L"RGB48", .mediaSubtype = MEDIASUBTYPE_RGB48, .frameServerFormatId = pfRGB48,     .bitCount = 48, .componentsPerPixel = 3, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB48 },
+    { .name = L"RGB64", .mediaSubtype = MEDIASUBTYPE_RGB64, .frameServerFormatId = pfRGB48,     .bitCount = 64, .componentsPerPixel = 4, .subsampleWidthRatio = -1, .subsampleHeightRatio = -1, .srcPlanesLayout = PlanesLayout::ALL_PLANES_INTERLEAVED,        .resourceId = IDC_INPUT_FORMAT_RGB64 },
 };
 
+auto Format::GetReducedFrameServerFormatId(int frameServerFormatId, int bitsPerComponent) -> std::optional<int> {
+    VSVideoFormat videoFormat;
+
+    // only integer YUV is reduced
+    if (!AVSF_VPS_API->getVideoFormatByID(&videoFormat, frameServerFormatId, AuxFrameServer::GetInstance().GetVsCore()) ||
+        videoFormat.colorFamily != cfYUV || videoFormat.sampleType != stInteger || videoFormat.bitsPerSample <= bitsPerComponent) {
+        return std::nullopt;
+    }
+
+    return AVSF_VPS_API->queryVideoFormatID(cfYUV, stInteger, bitsPerComponent, videoFormat.subSamplingW, videoFormat.subSamplingH, AuxFrameServer::GetInstance().GetVsCore());
+}
+
+auto Format::GetResampledFrameServerFormatId(int frameServerFormatId, int subsampleWidthRatio, int subsampleHeightRatio) -> std::optional<int> {
+    VSVideoFormat videoFormat;
+
+    // only integer YUV with chroma subsampled by at most 2 in each direction
+    if (!AVSF_VPS_API->getVideoFormatByID(&videoFormat, frameServerFormatId, AuxFrameServer::GetInstance().GetVsCore()) ||
+        videoFormat.colorFamily != cfYUV || videoFormat.sampleType != stInteger || videoFormat.subSamplingW > 1 || videoFormat.subSamplingH > 1) {
+        return std::nullopt;
+    }
+
+    const int subSamplingW = subsampleWidthRatio == 1 ? 0 : 1;
+    const int subSamplingH = subsampleHeightRatio == 1 ? 0 : 1;
+    if (videoFormat.subSamplingW == subSamplingW && videoFormat.subSamplingH == subSamplingH) {
+        return std::nullopt;
+    }
+
+    return AVSF_VPS_API->queryVideoFormatID(cfYUV, stInteger, videoFormat.bitsPerSample, subSamplingW, subSamplingH, AuxFrameServer::GetInstance().GetVsCore());
+}
+
+auto Format::IsConvertibleToRGB32(int frameServerFormatId) -> bool {
+    VSVideoFormat videoFormat;
+
+    // 8-bit planar YUV with chroma subsampled by at most 2 in each direction
+    return AVSF_VPS_API->getVideoFormatByID(&videoFormat, frameServerFormatId, AuxFrameServer::GetInstance().GetVsCore()) &&
+        videoFormat.colorFamily == cfYUV && videoFormat.sampleType == stInteger && videoFormat.bitsPerSample == 8 && videoFormat.subSamplingW <= 1 && videoFormat.subSamplingH <= 1;
+}
+
 auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBase *frameServerInstance) -> VideoFormat {
     const VIDEOINFOHEADER *vih = reinterpret_cast<VIDEOINFOHEADER *>(mediaType.pbFormat);
     REFERENCE_TIME fpsNum = UNITS;
@@ -47,15 +101,22 @@ auto Format::GetVideoFormat(const AM_MEDIA_TYPE &mediaType, const FrameServerBas
         .videoInfo = {
             .fpsNum = fpsNum,
             .fpsDen = fpsDen,
-            .width = vih->rcSource.right - vih->rcSource.left,
-            .height = vih->rcSource.bottom - vih->rcSource.top,
             .numFrames = NUM_FRAMES_FOR_INFINITE_STREAM,
         },
         .bmi = *GetBitmapInfo(mediaType),
         .frameServerCore = frameServerInstance->GetVsCore(),
+        .kernels = &_kernelTables[GetSupportedIntrinsicType()],
     };
     AVSF_VPS_API->getVideoFormatByID(&ret.videoInfo.format, ret.pixelFormat->frameServerFormatId, ret.frameServerCore);
     ret.outputBufferTemporalFlags = ret.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && ret.videoInfo.format.bitsPerSample == 10;
+    ret.UpdateVisibleRegion(*vih);
+
+    // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
+    // VapourSynth's zimg assumes the DIB being top-down, so we invert the DIB if needed
+    const bool isInverted = ret.bmi.biCompression == BI_RGB && ret.bmi.biHeight > 0;
+    ret.inputPlan = GetBufferPlan(ret, ret.sourceLeft, ret.sourceTop, ret.videoInfo.format.bytesPerSample, isInverted);
+    // CheckTransform() only accepts the output media types whose rcTarget is aligned for the stores of the kernels
+    ret.outputPlan = GetBufferPlan(ret, ret.targetLeft, ret.targetTop, ret.videoInfo.format.bytesPerSample, isInverted);
 
     if (SUCCEEDED(CheckVideoInfo2Type(&mediaType))) {
         const VIDEOINFOHEADER2 *vih2 = reinterpret_cast<VIDEOINFOHEADER2 *>(mediaType.pbFormat);
@@ -87,7 +148,7 @@ auto Format::WriteSample(const VideoFormat &videoFormat, const VSFrame *srcFrame
         srcStrides[i] = static_cast<int>(AVSF_VPS_API->getStride(srcFrame, i));
     }
 
-    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, AVSF_VPS_API->getFrameWidth(srcFrame, 0), AVSF_VPS_API->getFrameHeight(srcFrame, 0));
+    CopyToOutput(videoFormat, srcSlices, srcStrides, dstBuffer, AVSF_VPS_API->getFrameWidth(srcFrame, 0), AVSF_VPS_API->getFrameHeight(srcFrame, 0), *AVSF_VPS_API->getVideoInfo(MainFrameServer::GetInstance().GetScriptClip()));
 }
 
 auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer) -> VSFrame * {
@@ -106,173 +167,314 @@ auto Format::CreateFrame(const VideoFormat &videoFormat, const BYTE *srcBuffer)
 }
 
 auto Format::CopyFromInput(const VideoFormat &videoFormat, const BYTE *srcBuffer, const std::array<BYTE *, 3> &dstSlices, const std::array<int, 3> &dstStrides, int frameWidth, int height) -> void {
+    const KernelTable &kernels = *videoFormat.kernels;
     int srcMainPlaneRowSize = frameWidth * videoFormat.videoInfo.format.bytesPerSample;
     if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
         srcMainPlaneRowSize *= videoFormat.pixelFormat->componentsPerPixel;
+        // Y410 packs the four 10-bit components of each pixel in 32 bits instead of 64
+        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_Y410) {
+            srcMainPlaneRowSize /= 2;
+        }
+    } else if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED) {
+        srcMainPlaneRowSize = DivideRoundUp(frameWidth, V210_BLOCK_PIXELS) * V210_BLOCK_SIZE;
     }
 
-    // bmi.biWidth should be "set equal to the surface stride in pixels" according to the doc of BITMAPINFOHEADER
-    int srcMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.format.bytesPerSample * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(srcMainPlaneRowSize <= srcMainPlaneStride);
-    ASSERT(height == abs(videoFormat.bmi.biHeight));
-    const int srcMainPlaneSize = srcMainPlaneStride * height;
-    const BYTE *srcMainPlane = srcBuffer;
-    const int srcUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
-
-    // for RGB DIB in Windows (biCompression == BI_RGB), positive biHeight is bottom-up, negative is top-down
-    // VapourSynth's zimg assumes the input DIB being top-down, so we invert the DIB if needed
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight > 0) {
-        srcMainPlane += srcMainPlaneSize - srcMainPlaneStride;
-        srcMainPlaneStride = -srcMainPlaneStride;
-    }
-
-    if (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        vsh::bitblt(dstSlices[0], dstStrides[0], srcMainPlane, srcMainPlaneStride, srcMainPlaneRowSize, height);
-    }
-
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
-            const std::array yuvaSlices { dstSlices[1], dstSlices[0], dstSlices[2] };
-            const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
+    // the strides, the offsets of the visible region and the row order have been worked out from the media type
+    const VideoFormat::BufferPlan &srcPlan = videoFormat.inputPlan;
+    const int srcMainPlaneStride = srcPlan.mainPlaneStride;
+    const BYTE *srcMainPlane = srcBuffer + srcPlan.planeOffsets[0];
+    ASSERT(srcMainPlaneRowSize <= abs(srcMainPlaneStride));
+    ASSERT(height == videoFormat.videoInfo.height);
+
+    // P010, P210 and P410 have the samples aligned to the most significant bits, which are right shifted in the same pass as the copy
+    const bool isRightShiftNeeded = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.format.bitsPerSample == 10;
+    // ordinary loads from write-combined or uncached memory are extremely slow, so such source is streamed through a cacheable bounce buffer
+    const bool isStreamLoad = videoFormat.inputBufferTemporalFlags == 0b11 && IsStreamingAligned(videoFormat, srcMainPlane, srcMainPlaneStride);
+
+    ForEachStripe(videoFormat, srcMainPlaneStride, height, [&](int mainFirstRow, int mainRows, int uvFirstRow, int uvRows) -> void {
+        const BYTE *srcMainStripe = srcMainPlane + static_cast<ptrdiff_t>(mainFirstRow) * srcMainPlaneStride;
+        const std::array dstStripes { dstSlices[0] + mainFirstRow * dstStrides[0], dstSlices[1] + uvFirstRow * dstStrides[1], dstSlices[2] + uvFirstRow * dstStrides[2] };
+
+        if (isRightShiftNeeded) {
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                kernels.rightShiftFunc(bandSrc, bandSrcStride, dstStripes[0] + bandFirstRow * dstStrides[0], dstStrides[0], srcMainPlaneRowSize, bandHeight);
+            });
+        } else if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED || videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE) {
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                vsh::bitblt(dstStripes[0] + bandFirstRow * dstStrides[0], dstStrides[0], bandSrc, bandSrcStride, srcMainPlaneRowSize, bandHeight);
+            });
+        }
 
-            if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-                DeinterleaveY410(srcMainPlane, srcMainPlaneStride / 2, yuvaSlices, yuvaStrides, srcMainPlaneRowSize / 2, height);
+        switch (videoFormat.pixelFormat->srcPlanesLayout) {
+        case PlanesLayout::ALL_PLANES_INTERLEAVED:
+            if (videoFormat.videoInfo.format.colorFamily == cfYUV && videoFormat.pixelFormat->subsampleWidthRatio == 2) {
+                decltype(kernels.deinterleaveY216Func) deinterleaveYUYVFunc;
+                if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                    deinterleaveYUYVFunc = videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_UYVY ? kernels.deinterleaveUYVYFunc : kernels.deinterleaveYUY2Func;
+                } else if (videoFormat.videoInfo.format.bitsPerSample == 10) {
+                    deinterleaveYUYVFunc = kernels.deinterleaveY210Func;
+                } else {
+                    deinterleaveYUYVFunc = kernels.deinterleaveY216Func;
+                }
+
+                ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                    deinterleaveYUYVFunc(bandSrc, bandSrcStride, OffsetRows(dstStripes, dstStrides, bandFirstRow), dstStrides, srcMainPlaneRowSize, bandHeight);
+                });
+            } else if (videoFormat.videoInfo.format.colorFamily == cfYUV && videoFormat.videoInfo.format.bytesPerSample == 1) {
+                // AYUV has the same layout as RGB32, with V, U and Y in place of B, G and R
+                const std::array vuyaSlices { dstStripes[2], dstStripes[1], dstStripes[0] };
+                const std::array vuyaStrides { dstStrides[2], dstStrides[1], dstStrides[0] };
+
+                ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                    kernels.deinterleaveRGBC1Func(bandSrc, bandSrcStride, OffsetRows(vuyaSlices, vuyaStrides, bandFirstRow), vuyaStrides, srcMainPlaneRowSize, bandHeight);
+                });
+            } else if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
+                const std::array yuvaSlices { dstStripes[1], dstStripes[0], dstStripes[2] };
+                const std::array yuvaStrides { dstStrides[1], dstStrides[0], dstStrides[2] };
+
+                if (videoFormat.videoInfo.format.bitsPerSample == 10) {
+                    ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                        kernels.deinterleaveY410Func(bandSrc, bandSrcStride, OffsetRows(yuvaSlices, yuvaStrides, bandFirstRow), yuvaStrides, srcMainPlaneRowSize, bandHeight);
+                    });
+                } else {
+                    ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                        kernels.deinterleaveY416Func(bandSrc, bandSrcStride, OffsetRows(yuvaSlices, yuvaStrides, bandFirstRow), yuvaStrides, srcMainPlaneRowSize, bandHeight);
+                    });
+                }
             } else {
-                _deinterleaveY416Func(srcMainPlane, srcMainPlaneStride, yuvaSlices, yuvaStrides, srcMainPlaneRowSize, height);
+                decltype(kernels.deinterleaveRGBC1Func) deinterleaveRGBFunc;
+                std::array rgbSlices = dstStripes;
+                std::array rgbStrides = dstStrides;
+
+                if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                    deinterleaveRGBFunc = videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.deinterleaveRGB24Func : kernels.deinterleaveRGBC1Func;
+                } else {
+                    // the alpha component of RGB64 is discarded the same way as Y416
+                    deinterleaveRGBFunc = videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.deinterleaveRGB48Func : kernels.deinterleaveY416Func;
+                    std::swap(rgbSlices[0], rgbSlices[2]);
+                    std::swap(rgbStrides[0], rgbStrides[2]);
+                }
+
+                ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                    deinterleaveRGBFunc(bandSrc, bandSrcStride, OffsetRows(rgbSlices, rgbStrides, bandFirstRow), rgbStrides, srcMainPlaneRowSize, bandHeight);
+                });
             }
-        } else {
-            _deinterleaveRGBC1Func(srcMainPlane, srcMainPlaneStride, dstSlices, dstStrides, srcMainPlaneRowSize, height);
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        const BYTE *srcUVStart = srcMainPlane + srcMainPlaneSize;
-        const int srcUVStride = srcMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
-        if (videoFormat.videoInfo.format.bytesPerSample == 1) {
-            deinterleaveUVFunc = _deinterleaveUVC1Func;
-        } else {
-            deinterleaveUVFunc = _deinterleaveUVC2Func;
-        }
-        deinterleaveUVFunc(srcUVStart, srcUVStride, { dstSlices[1], dstSlices[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, srcUVHeight);
-
-        if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-            _rightShiftFunc(dstSlices[0], dstSlices[0], dstStrides[0], srcMainPlaneRowSize, height);
-            _rightShiftFunc(dstSlices[1], dstSlices[1], dstStrides[1], srcUVRowSize / 2, srcUVHeight);
-            _rightShiftFunc(dstSlices[2], dstSlices[2], dstStrides[2], srcUVRowSize / 2, srcUVHeight);
-        }
-    } break;
-
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int srcUVStride = srcMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        const BYTE *srcUVPlane1 = srcMainPlane + srcMainPlaneSize;
-        const BYTE *srcUVPlane2 = srcUVPlane1 + srcMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        const BYTE *srcU;
-        const BYTE *srcV;
-        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
-            // YVxx has V plane first
-            srcU = srcUVPlane2;
-            srcV = srcUVPlane1;
-        } else {
-            srcU = srcUVPlane1;
-            srcV = srcUVPlane2;
+            break;
+
+        case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
+            const int srcUVStride = srcPlan.uvPlaneStride;
+            const BYTE *srcUVStart = srcBuffer + srcPlan.planeOffsets[1] + static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+            const int srcUVRowSize = srcMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
+
+            decltype(Deinterleave<0, 1, 2, 2, 1>) *deinterleaveUVFunc;
+            if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                deinterleaveUVFunc = kernels.deinterleaveUVC1Func;
+            } else if (isRightShiftNeeded) {
+                deinterleaveUVFunc = kernels.deinterleaveUVC2ShiftFunc;
+            } else {
+                deinterleaveUVFunc = kernels.deinterleaveUVC2Func;
+            }
+            ReadInBands(videoFormat, srcUVStart, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                deinterleaveUVFunc(bandSrc, bandSrcStride, { dstStripes[1] + bandFirstRow * dstStrides[1], dstStripes[2] + bandFirstRow * dstStrides[2] }, { dstStrides[1], dstStrides[2] }, srcUVRowSize, bandHeight);
+            });
+        } break;
+
+        case PlanesLayout::ALL_PLANES_SEPARATE: {
+            const int srcUVStride = srcPlan.uvPlaneStride;
+            const int srcUVRowSize = srcMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
+            const BYTE *srcUVPlane1 = srcBuffer + srcPlan.planeOffsets[1];
+            const BYTE *srcUVPlane2 = srcBuffer + srcPlan.planeOffsets[2];
+
+            const BYTE *srcU;
+            const BYTE *srcV;
+            if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
+                // YVxx has V plane first
+                srcU = srcUVPlane2;
+                srcV = srcUVPlane1;
+            } else {
+                srcU = srcUVPlane1;
+                srcV = srcUVPlane2;
+            }
+            srcU += static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+            srcV += static_cast<ptrdiff_t>(uvFirstRow) * srcUVStride;
+
+            ReadInBands(videoFormat, srcU, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                vsh::bitblt(dstStripes[1] + bandFirstRow * dstStrides[1], dstStrides[1], bandSrc, bandSrcStride, srcUVRowSize, bandHeight);
+            });
+            ReadInBands(videoFormat, srcV, srcUVStride, srcUVRowSize, uvRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                vsh::bitblt(dstStripes[2] + bandFirstRow * dstStrides[2], dstStrides[2], bandSrc, bandSrcStride, srcUVRowSize, bandHeight);
+            });
+        } break;
+
+        case PlanesLayout::ALL_PLANES_BIT_PACKED:
+            ReadInBands(videoFormat, srcMainStripe, srcMainPlaneStride, srcMainPlaneRowSize, mainRows, isStreamLoad, [&](const BYTE *bandSrc, int bandSrcStride, int bandFirstRow, int bandHeight) -> void {
+                kernels.unpackV210Func(bandSrc, bandSrcStride, OffsetRows(dstStripes, dstStrides, bandFirstRow), dstStrides, frameWidth, bandHeight);
+            });
+            break;
         }
-
-        vsh::bitblt(dstSlices[1], dstStrides[1], srcU, srcUVStride, srcUVRowSize, srcUVHeight);
-        vsh::bitblt(dstSlices[2], dstStrides[2], srcV, srcUVStride, srcUVRowSize, srcUVHeight);
-    } break;
-    }
+    });
 }
 
-auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height) -> void {
+auto Format::CopyToOutput(const VideoFormat &videoFormat, const std::array<const BYTE *, 3> &srcSlices, const std::array<int, 3> &srcStrides, BYTE *dstBuffer, int frameWidth, int height, const VSVideoInfo &srcVideoInfo) -> void {
+    const KernelTable &kernels = *videoFormat.kernels;
+    // the script output of higher bit depth is reduced to the output format with ordered dither in the same pass as the interleaving
+    const bool isBitDepthReduced = srcVideoInfo.format.bitsPerSample > videoFormat.videoInfo.format.bitsPerSample;
+    // planar YUV script output is converted to RGB32 in the same pass as the copy
+    const bool isYUVToRGB = srcVideoInfo.format.colorFamily == cfYUV && videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_RGB32;
+    // chroma of different subsampling is resampled to the semi-planar output in the same pass as the interleaving
+    const bool isChromaResampled = videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && srcVideoInfo.format.colorFamily == cfYUV &&
+        (1 << srcVideoInfo.format.subSamplingW != videoFormat.pixelFormat->subsampleWidthRatio || 1 << srcVideoInfo.format.subSamplingH != videoFormat.pixelFormat->subsampleHeightRatio);
+
     int dstMainPlaneRowSize = frameWidth * videoFormat.videoInfo.format.bytesPerSample;
     if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_INTERLEAVED) {
         dstMainPlaneRowSize *= videoFormat.pixelFormat->componentsPerPixel;
+        // Y410 packs the four 10-bit components of each pixel in 32 bits instead of 64
+        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_Y410) {
+            dstMainPlaneRowSize /= 2;
+        }
+    } else if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_BIT_PACKED) {
+        dstMainPlaneRowSize = DivideRoundUp(frameWidth, V210_BLOCK_PIXELS) * V210_BLOCK_SIZE;
     }
 
-    int dstMainPlaneStride = videoFormat.bmi.biWidth * videoFormat.videoInfo.format.bytesPerSample * videoFormat.pixelFormat->componentsPerPixel;
-    ASSERT(dstMainPlaneRowSize <= dstMainPlaneStride);
-    ASSERT(height >= abs(videoFormat.bmi.biHeight));
-    const int dstMainPlaneSize = dstMainPlaneStride * height;
-    const int dstUVHeight = height / videoFormat.pixelFormat->subsampleHeightRatio;
-
-    BYTE *intermediateDstBufferBase = dstBuffer;
-    if (videoFormat.outputBufferTemporalFlags == 0b111) {
-        intermediateDstBufferBase = reinterpret_cast<BYTE *>(CoTaskMemAlloc(videoFormat.bmi.biSizeImage));
+    // the frame is written to the region of rcTarget, which has been located from the media type
+    const VideoFormat::BufferPlan &dstPlan = videoFormat.outputPlan;
+    const int dstMainPlaneStride = dstPlan.mainPlaneStride;
+    BYTE *dstMainPlane = dstBuffer + dstPlan.planeOffsets[0];
+    ASSERT(dstMainPlaneRowSize <= abs(dstMainPlaneStride));
+    ASSERT(height == videoFormat.videoInfo.height);
+
+    // P010, P210 and P410 expect the samples aligned to the most significant bits, which are left shifted in the same pass as the copy
+    const bool isLeftShiftNeeded = !isBitDepthReduced && videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED && videoFormat.videoInfo.format.bitsPerSample == 10;
+    // reading back from write-combined memory is extremely slow, so such destination is only written, and with non-temporal stores when possible
+    const bool isNonTemporal = isLeftShiftNeeded && videoFormat.outputBufferTemporalFlags == 0b111 && IsStreamingAligned(videoFormat, dstMainPlane, dstMainPlaneStride);
+
+    YUVToRGBCoefficients yuvToRGBCoeffs {};
+    if (isYUVToRGB) {
+        yuvToRGBCoeffs = GetYUVToRGBCoefficients(videoFormat);
     }
-    BYTE *dstMainPlane = intermediateDstBufferBase;
 
-    if (videoFormat.bmi.biCompression == BI_RGB && videoFormat.bmi.biHeight > 0) {
-        dstMainPlane += dstMainPlaneSize - dstMainPlaneStride;
-        dstMainPlaneStride = -dstMainPlaneStride;
-    }
+    ForEachStripe(videoFormat, dstMainPlaneStride, height, [&](int mainFirstRow, int mainRows, int uvFirstRow, int uvRows) -> void {
+        BYTE *dstMainStripe = dstMainPlane + static_cast<ptrdiff_t>(mainFirstRow) * dstMainPlaneStride;
 
-    if (videoFormat.pixelFormat->srcPlanesLayout != PlanesLayout::ALL_PLANES_INTERLEAVED) {
-        vsh::bitblt(dstMainPlane, dstMainPlaneStride, srcSlices[0], srcStrides[0], dstMainPlaneRowSize, height);
-    }
+        if (isYUVToRGB) {
+            // the stripes follow the rows of RGB32, so the source rows are located from the frame
+            (srcVideoInfo.format.subSamplingW == 0 ? kernels.yuvToRGB32Func : kernels.yuvToRGB32SubsampledFunc)(srcSlices, srcStrides, dstMainStripe, dstMainPlaneStride, frameWidth, mainRows, mainFirstRow, 1 << srcVideoInfo.format.subSamplingH, yuvToRGBCoeffs);
+            return;
+        }
 
-    switch (videoFormat.pixelFormat->srcPlanesLayout) {
-    case PlanesLayout::ALL_PLANES_INTERLEAVED:
-        if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
-            const std::array yuvaSlices { srcSlices[1], srcSlices[0], srcSlices[2] };
-            const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
+        const std::array srcStripes { srcSlices[0] + mainFirstRow * srcStrides[0], srcSlices[1] + uvFirstRow * srcStrides[1], srcSlices[2] + uvFirstRow * srcStrides[2] };
 
-            if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-                InterleaveY410(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride / 2, dstMainPlaneRowSize / 2, height);
+        if (isBitDepthReduced) {
+            (videoFormat.videoInfo.format.bytesPerSample == 1 ? kernels.reduceBitDepthC1Func : kernels.reduceBitDepthC2Func)(srcStripes[0], srcStrides[0], dstMainStripe, dstMainPlaneStride, frameWidth, mainRows, srcVideoInfo.format.bitsPerSample, mainFirstRow);
+        } else if (isLeftShiftNeeded) {
+            (isNonTemporal ? kernels.leftShiftStreamFunc : kernels.leftShiftFunc)(srcStripes[0], srcStrides[0], dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+        } else if (videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED || videoFormat.pixelFormat->srcPlanesLayout == PlanesLayout::ALL_PLANES_SEPARATE) {
+            vsh::bitblt(dstMainStripe, dstMainPlaneStride, srcStripes[0], srcStrides[0], dstMainPlaneRowSize, mainRows);
+        }
+
+        switch (videoFormat.pixelFormat->srcPlanesLayout) {
+        case PlanesLayout::ALL_PLANES_INTERLEAVED:
+            if (videoFormat.videoInfo.format.colorFamily == cfYUV && videoFormat.pixelFormat->subsampleWidthRatio == 2) {
+                decltype(kernels.interleaveY216Func) interleaveYUYVFunc;
+                if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                    interleaveYUYVFunc = videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_UYVY ? kernels.interleaveUYVYFunc : kernels.interleaveYUY2Func;
+                } else if (videoFormat.videoInfo.format.bitsPerSample == 10) {
+                    interleaveYUYVFunc = kernels.interleaveY210Func;
+                } else {
+                    interleaveYUYVFunc = kernels.interleaveY216Func;
+                }
+                interleaveYUYVFunc(srcStripes, srcStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+            } else if (videoFormat.videoInfo.format.colorFamily == cfYUV && videoFormat.videoInfo.format.bytesPerSample == 1) {
+                // the alpha component of AYUV is filled the same way as RGB32
+                const std::array vuyaSlices { srcStripes[2], srcStripes[1], srcStripes[0] };
+                const std::array vuyaStrides { srcStrides[2], srcStrides[1], srcStrides[0] };
+
+                kernels.interleaveRGBC1Func(vuyaSlices, vuyaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+            } else if (videoFormat.videoInfo.format.colorFamily == cfYUV) {
+                const std::array yuvaSlices { srcStripes[1], srcStripes[0], srcStripes[2] };
+                const std::array yuvaStrides { srcStrides[1], srcStrides[0], srcStrides[2] };
+
+                if (videoFormat.videoInfo.format.bitsPerSample == 10) {
+                    kernels.interleaveY410Func(yuvaSlices, yuvaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+                } else {
+                    kernels.interleaveY416Func(yuvaSlices, yuvaStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
+                }
             } else {
-                _interleaveY416Func(yuvaSlices, yuvaStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize, height);
+                decltype(kernels.interleaveRGBC1Func) interleaveRGBFunc;
+                std::array rgbSlices = srcStripes;
+                std::array rgbStrides = srcStrides;
+
+                if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                    interleaveRGBFunc = videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.interleaveRGB24Func : kernels.interleaveRGBC1Func;
+                } else {
+                    // the alpha component of RGB64 is filled the same way as Y416
+                    interleaveRGBFunc = videoFormat.pixelFormat->componentsPerPixel == 3 ? kernels.interleaveRGB48Func : kernels.interleaveY416Func;
+                    std::swap(rgbSlices[0], rgbSlices[2]);
+                    std::swap(rgbStrides[0], rgbStrides[2]);
+                }
+
+                interleaveRGBFunc(rgbSlices, rgbStrides, dstMainStripe, dstMainPlaneStride, dstMainPlaneRowSize, mainRows);
             }
-        } else {
-            _interleaveRGBC1Func(srcSlices, srcStrides, dstMainPlane, dstMainPlaneStride, dstMainPlaneRowSize, height);
-        }
-        break;
-
-    case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
-        BYTE *dstUVStart = dstMainPlane + dstMainPlaneSize;
-        const int dstUVStride = dstMainPlaneStride * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
-
-        decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
-        if (videoFormat.videoInfo.format.bytesPerSample == 1) {
-            interleaveUVFunc = _interleaveUVC1Func;
-        } else {
-            interleaveUVFunc = _interleaveUVC2Func;
-        }
-        interleaveUVFunc(srcSlices[1], srcSlices[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, dstUVHeight);
+            break;
+
+        case PlanesLayout::MAIN_SEPARATE_SEC_INTERLEAVED: {
+            const int dstUVStride = dstPlan.uvPlaneStride;
+            BYTE *dstUVPlane = dstBuffer + dstPlan.planeOffsets[1];
+            BYTE *dstUVStart = dstUVPlane + static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
+            const int dstUVRowSize = dstMainPlaneRowSize * 2 / videoFormat.pixelFormat->subsampleWidthRatio;
 
-        if (videoFormat.videoInfo.format.bitsPerSample == 10) {
-            _leftShiftFunc(dstMainPlane, dstBuffer, dstMainPlaneStride, dstMainPlaneRowSize, height + dstUVHeight);
-            if (videoFormat.outputBufferTemporalFlags == 0b111) {
-                CoTaskMemFree(intermediateDstBufferBase);
+            if (isBitDepthReduced) {
+                (videoFormat.videoInfo.format.bytesPerSample == 1 ? kernels.interleaveUVReduceC1Func : kernels.interleaveUVReduceC2Func)(srcStripes[1], srcStripes[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, frameWidth / videoFormat.pixelFormat->subsampleWidthRatio, uvRows, srcVideoInfo.format.bitsPerSample, uvFirstRow);
+                break;
             }
-        }
-    } break;
-
-    case PlanesLayout::ALL_PLANES_SEPARATE: {
-        const int dstUVStride = dstMainPlaneStride / videoFormat.pixelFormat->subsampleWidthRatio;
-        const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
-        BYTE *dstUVPlane1 = dstMainPlane + dstMainPlaneSize;
-        BYTE *dstUVPlane2 = dstUVPlane1 + dstMainPlaneSize / (videoFormat.pixelFormat->subsampleWidthRatio * videoFormat.pixelFormat->subsampleHeightRatio);
-
-        BYTE *dstU;
-        BYTE *dstV;
-        if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
-            dstU = dstUVPlane2;
-            dstV = dstUVPlane1;
-        } else {
-            dstU = dstUVPlane1;
-            dstV = dstUVPlane2;
-        }
 
-        vsh::bitblt(dstU, dstUVStride, srcSlices[1], srcStrides[1], dstUVRowSize, dstUVHeight);
-        vsh::bitblt(dstV, dstUVStride, srcSlices[2], srcStrides[2], dstUVRowSize, dstUVHeight);
-    } break;
-    }
+            if (isChromaResampled) {
+                // the stripes follow the chroma rows of the output, so the source rows are located from the frame
+                ResampleInterleaveUV(videoFormat, srcSlices, srcStrides, 1 << srcVideoInfo.format.subSamplingW, 1 << srcVideoInfo.format.subSamplingH, dstUVPlane, dstUVStride,
+                                     frameWidth, height, videoFormat.videoInfo.format.bytesPerSample, isLeftShiftNeeded, uvFirstRow, uvRows);
+                break;
+            }
+
+            decltype(InterleaveUV<0, 1>) *interleaveUVFunc;
+            if (videoFormat.videoInfo.format.bytesPerSample == 1) {
+                interleaveUVFunc = kernels.interleaveUVC1Func;
+            } else if (isNonTemporal) {
+                interleaveUVFunc = kernels.interleaveUVC2ShiftStreamFunc;
+            } else if (isLeftShiftNeeded) {
+                interleaveUVFunc = kernels.interleaveUVC2ShiftFunc;
+            } else {
+                interleaveUVFunc = kernels.interleaveUVC2Func;
+            }
+            interleaveUVFunc(srcStripes[1], srcStripes[2], srcStrides[1], srcStrides[2], dstUVStart, dstUVStride, dstUVRowSize, uvRows);
+        } break;
+
+        case PlanesLayout::ALL_PLANES_SEPARATE: {
+            const int dstUVStride = dstPlan.uvPlaneStride;
+            const int dstUVRowSize = dstMainPlaneRowSize / videoFormat.pixelFormat->subsampleWidthRatio;
+            BYTE *dstUVPlane1 = dstBuffer + dstPlan.planeOffsets[1];
+            BYTE *dstUVPlane2 = dstBuffer + dstPlan.planeOffsets[2];
+
+            BYTE *dstU;
+            BYTE *dstV;
+            if (videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV12 || videoFormat.pixelFormat->mediaSubtype == MEDIASUBTYPE_YV24) {
+                dstU = dstUVPlane2;
+                dstV = dstUVPlane1;
+            } else {
+                dstU = dstUVPlane1;
+                dstV = dstUVPlane2;
+            }
+            dstU += static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
+            dstV += static_cast<ptrdiff_t>(uvFirstRow) * dstUVStride;
+
+            vsh::bitblt(dstU, dstUVStride, srcStripes[1], srcStrides[1], dstUVRowSize, uvRows);
+            vsh::bitblt(dstV, dstUVStride, srcStripes[2], srcStrides[2], dstUVRowSize, uvRows);
+        } break;
+
+        case PlanesLayout::ALL_PLANES_BIT_PACKED:
+            kernels.packV210Func(srcStripes, srcStrides, dstMainStripe, dstMainPlaneStride, frameWidth, mainRows);
+            break;
+        }
+    });
 }
 
 }
@@ -65,6 +65,12 @@ auto FrameHandler::AddInputSample(IMediaSample *inputSample) -> HRESULT {
         return S_FALSE;
     }
 
+    if (_filter._inputVideoFormat.inputBufferTemporalFlags == 0) {
+        MEMORY_BASIC_INFORMATION srcBufferInfo;
+        VirtualQuery(sampleBuffer, &srcBufferInfo, sizeof(srcBufferInfo));
+        _filter._inputVideoFormat.inputBufferTemporalFlags = (((srcBufferInfo.Protect & (PAGE_WRITECOMBINE | PAGE_NOCACHE)) != 0) << 1) + 0b1;
+    }
+
     VSFrame *frame = Format::CreateFrame(_filter._inputVideoFormat, sampleBuffer);
     VSMap *frameProps = AVSF_VPS_API->getFramePropertiesRW(frame);
 